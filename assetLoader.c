@@ -0,0 +1,205 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+#include "raylib.h"
+#include "assetLoader.h"
+#include "mapCache.h"
+#include "platform.h"
+
+// --- ASSET PATHS ---
+const char *BACKGROUND_PATH = "assets/map.jpg";
+const char *BORDERS_IMAGE_PATH = "assets/mapWithBorders.png";
+const char *BORDERS_CACHE_PATH = "assets/mapWithBorders.cache";
+const char *MUSIC_PATH = "assets/background_music.mp3";
+const char *HORN_PATH = "assets/horn.mp3";
+
+/*
+Job: decodes the map's picture into RAM
+Parameter: Pointer to the loader (*data)
+*/
+static void decodeBackground(void *data) {
+    AssetLoader *loader = data;
+    loader->backgroundImage = LoadImage(BACKGROUND_PATH);
+}
+
+/*
+Job: splits the map's picture into tiles
+Parameter: Pointer to the loader (*data)
+*/
+static void tileBackground(void *data) {
+    AssetLoader *loader = data;
+    loader->background = LoadMapTiles(loader->backgroundImage, MAP_TILE_SIZE);
+}
+
+/*
+Job: downsamples the map's picture for the minimap
+Parameter: Pointer to the loader (*data)
+*/
+static void bakeMinimap(void *data) {
+    AssetLoader *loader = data;
+    loader->minimapImage = BakeMinimapImage(loader->backgroundImage, MINIMAP_ZOOM);
+}
+
+/*
+Job: decodes the horn's sound effect into RAM
+Parameter: Pointer to the loader (*data)
+*/
+static void decodeHorn(void *data) {
+    AssetLoader *loader = data;
+    loader->hornWave = LoadWave(HORN_PATH);
+}
+
+/*
+Job: loads map's data from the cache, or decodes the borders' image if the cache is stale
+Parameter: Pointer to the loader (*data)
+*/
+static void loadBorders(void *data) {
+    AssetLoader *loader = data;
+    loader->bordersHash = HashFileContents(BORDERS_IMAGE_PATH);
+    loader->cacheHit = loader->bordersHash != 0 && LoadMapCache(BORDERS_CACHE_PATH, loader->bordersHash, &loader->map);
+    if (!loader->cacheHit) loader->borders = LoadImage(BORDERS_IMAGE_PATH);
+}
+
+/*
+Job: preprocesses the borders' image (bitsets, distance field, pose masks, buildings). Nothing to do on a cache hit
+Parameter: Pointer to the loader (*data)
+*/
+static void bakeMap(void *data) {
+    AssetLoader *loader = data;
+    if (loader->cacheHit) return;
+    loader->map = BakeMapData(loader->borders, BORDERS_CACHE_PATH, loader->bordersHash);
+    UnloadImage(loader->borders); // Everything we need from it is baked
+    loader->borders = (Image){0};
+}
+
+/*
+Starts the job system and submits the startup's jobs. Call it before InitWindow,
+so that decoding overlaps with the creation of the window
+Parameter: Pointer to the loader (*loader)
+*/
+void BeginAssetLoading(AssetLoader *loader) {
+    *loader = (AssetLoader){0};
+    loader->startTime = GetPreciseTime();
+    InitJobSystem(0);
+
+    InitJob(&loader->decodeBackground, "decode map.jpg", decodeBackground, loader);
+    InitJob(&loader->tileBackground, "split map into tiles", tileBackground, loader);
+    InitJob(&loader->bakeMinimap, "downsample minimap", bakeMinimap, loader);
+    InitJob(&loader->decodeHorn, "decode horn.mp3", decodeHorn, loader);
+    InitJob(&loader->loadBorders, "load borders/cache", loadBorders, loader);
+    InitJob(&loader->bakeMap, "preprocess map", bakeMap, loader);
+    AddJobDependency(&loader->bakeMap, &loader->loadBorders);
+    AddJobDependency(&loader->tileBackground, &loader->decodeBackground);
+    AddJobDependency(&loader->bakeMinimap, &loader->decodeBackground);
+
+    // Longest chain first
+    SubmitJob(&loader->loadBorders);
+    SubmitJob(&loader->bakeMap);
+    SubmitJob(&loader->decodeBackground);
+    SubmitJob(&loader->tileBackground);
+    SubmitJob(&loader->bakeMinimap);
+    SubmitJob(&loader->decodeHorn);
+}
+
+/*
+Loads only the map's data (from the cache, or baked from the borders' image), for runs without a window or audio device
+Returns: Map's data (MapData). Must be freed with UnloadMapData and UnloadMapLocations
+*/
+MapData LoadMapAssets(void) {
+    AssetLoader loader = {0};
+    loadBorders(&loader);
+    bakeMap(&loader);
+    return loader.map;
+}
+
+/*
+Waits for the startup's jobs and uploads their results on the main thread. Window and audio device must be initialized
+Parameter: Pointer to the loader (*loader)
+Returns: Game's assets (GameAssets). Must be freed with UnloadGameAssets
+*/
+GameAssets FinishAssetLoading(AssetLoader *loader) {
+    GameAssets assets = {0};
+    double start = GetPreciseTime();
+
+    // The music streams from its file, so there is nothing to decode ahead of time
+    assets.backgroundMusic = LoadMusicStream(MUSIC_PATH);
+    RecordStartupStage(loader, "open music stream", start);
+
+    start = GetPreciseTime();
+    WaitForJob(&loader->decodeHorn);
+    assets.horn = LoadSoundFromWave(loader->hornWave);
+    UnloadWave(loader->hornWave);
+    RecordStartupStage(loader, "upload horn", start);
+
+    start = GetPreciseTime();
+    WaitForJob(&loader->tileBackground);
+    WaitForJob(&loader->bakeMinimap);
+    UnloadImage(loader->backgroundImage);
+    assets.background = loader->background;
+    assets.minimap = LoadMinimap(loader->minimapImage, assets.background.width, MINIMAP_WIDTH, MINIMAP_HEIGHT, MINIMAP_ZOOM, MINIMAP_UPDATE_RATE);
+    UnloadImage(loader->minimapImage);
+    RecordStartupStage(loader, "upload minimap", start);
+
+    start = GetPreciseTime();
+    WaitForJob(&loader->bakeMap);
+    assets.map = loader->map;
+    RecordStartupStage(loader, "wait for map data", start);
+
+    return assets;
+}
+
+/*
+Records the timing of a startup step that ran on the main thread, until now
+Parameters: Pointer to the loader (*loader), step's name (*name) and GetPreciseTime() when it started (startTime)
+*/
+void RecordStartupStage(AssetLoader *loader, const char *name, double startTime) {
+    if (loader->stageCount == MAX_STARTUP_STAGES) return;
+    loader->stages[loader->stageCount++] = (StartupStage){ name, startTime, GetPreciseTime() };
+}
+
+/*
+Logs when every startup step started and finished (relative to BeginAssetLoading) and on which thread it ran
+Parameter: Pointer to the loader (*loader)
+*/
+void LogStartupTimings(const AssetLoader *loader) {
+    const Job *jobs[] = { &loader->loadBorders, &loader->bakeMap, &loader->decodeBackground, &loader->tileBackground, &loader->bakeMinimap, &loader->decodeHorn };
+    int jobCount = sizeof(jobs) / sizeof(jobs[0]);
+    double t0 = loader->startTime;
+    double end = t0;
+
+    TraceLog(LOG_INFO, "STARTUP: %d worker threads%s", GetJobWorkerCount(), loader->cacheHit ? ", map cache hit" : "");
+    for (int i = 0; i < jobCount; i++) {
+        const char *thread = (jobs[i]->worker == 0) ? "main" : TextFormat("worker %d", jobs[i]->worker);
+        TraceLog(LOG_INFO, "STARTUP: %-20s %8.2f -> %8.2f ms (%7.2f ms) %s", jobs[i]->name,
+                 (jobs[i]->startTime - t0) * 1e3, (jobs[i]->endTime - t0) * 1e3, (jobs[i]->endTime - jobs[i]->startTime) * 1e3, thread);
+        if (jobs[i]->endTime > end) end = jobs[i]->endTime;
+    }
+    for (int i = 0; i < loader->stageCount; i++) {
+        const StartupStage *stage = &loader->stages[i];
+        TraceLog(LOG_INFO, "STARTUP: %-20s %8.2f -> %8.2f ms (%7.2f ms) main", stage->name,
+                 (stage->startTime - t0) * 1e3, (stage->endTime - t0) * 1e3, (stage->endTime - stage->startTime) * 1e3);
+        if (stage->endTime > end) end = stage->endTime;
+    }
+    TraceLog(LOG_INFO, "STARTUP: Total %.2f ms", (end - t0) * 1e3);
+}
+
+/*
+Frees game's assets
+Parameter: Pointer to the assets (*assets)
+*/
+void UnloadGameAssets(GameAssets *assets) {
+    UnloadMapTiles(&assets->background);
+    UnloadMinimap(&assets->minimap);
+    UnloadMapData(&assets->map);
+    UnloadMusicStream(assets->backgroundMusic);
+    UnloadSound(assets->horn);
+}
@@ -0,0 +1,75 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+#ifndef ASSETLOADER_H
+#define ASSETLOADER_H
+
+#include <stdint.h>
+#include "raylib.h"
+#include "mapData.h"
+#include "mapTiles.h"
+#include "minimap.h"
+#include "jobs.h"
+
+#define MAX_STARTUP_STAGES 16
+
+// A step of the startup that ran on the main thread
+typedef struct {
+    const char *name;
+    double startTime;
+    double endTime;
+} StartupStage;
+
+// Startup's job graph. CPU work (decoding, preprocessing) runs on the job system's workers,
+// while everything that talks to the GPU or the audio device stays on the main thread
+typedef struct {
+    double startTime;
+
+    // Filled by the jobs
+    Image backgroundImage; // Freed once both tiles and minimap are baked from it
+    MapTiles background;
+    Image minimapImage;
+    Wave hornWave;
+    Image borders;
+    uint64_t bordersHash;
+    bool cacheHit;
+    MapData map;
+
+    Job decodeBackground;
+    Job tileBackground;
+    Job bakeMinimap;
+    Job decodeHorn;
+    Job loadBorders; // Map cache, or the borders' image when the cache is stale
+    Job bakeMap;     // Preprocessing, runs as soon as loadBorders is done
+
+    StartupStage stages[MAX_STARTUP_STAGES];
+    int stageCount;
+} AssetLoader;
+
+// Everything the game needs, ready to use
+typedef struct {
+    MapTiles background; // Uploaded to the GPU tile by tile, while drawing
+    Minimap minimap;
+    MapData map;
+    Music backgroundMusic;
+    Sound horn;
+} GameAssets;
+
+// functions
+void BeginAssetLoading(AssetLoader *loader);
+GameAssets FinishAssetLoading(AssetLoader *loader);
+MapData LoadMapAssets(void);
+void RecordStartupStage(AssetLoader *loader, const char *name, double startTime);
+void LogStartupTimings(const AssetLoader *loader);
+void UnloadGameAssets(GameAssets *assets);
+
+#endif
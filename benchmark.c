@@ -0,0 +1,575 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include "raylib.h"
+#include "colorClassify.h"
+#include "mapData.h"
+#include "roadRouter.h"
+#include "vehicles.h"
+#include "helpers.h"
+#include "jobs.h"
+#include "platform.h"
+
+// --- BENCHMARK CONSTANTS ---
+const char *BORDERS_PATH = "assets/mapWithBorders.png";
+const int CLASSIFY_RUNS = 10;
+const int TRAFFIC_VEHICLES = 100000;
+const int TRAFFIC_WARMUP_STEPS = 10;
+const int TRAFFIC_STEPS = 100;
+const int TRAFFIC_SEED = 1234;
+const double MIN_BENCH_SECONDS = 0.2; // Every measurement repeats its batch until it has run this long
+const int QUERY_COUNT = 4096;         // Random inputs per primitive, reused across batches
+const int DEFAULT_VEHICLE_COUNTS[] = { 20, 2000, 20000, 100000 };
+const int DEFAULT_MAP_SCALES[] = { 1, 2, 4 }; // The shipped map, tiled 2x2 and 4x4
+#define MAX_RESULTS 256
+#define MAX_SWEEP 16
+
+// Game's globals that helpers.c reads
+float difficultyFactor = 0.5f;
+
+// One measurement, printed as a table row and saved in the JSON report
+typedef struct {
+    char name[48];
+    int mapWidth;
+    int mapHeight;
+    int vehicles; // 0 if it doesn't apply
+    int threads;
+    double nsPerOp;
+    double opsPerSecond;
+} BenchResult;
+
+static BenchResult results[MAX_RESULTS];
+static int resultCount = 0;
+static FILE *tables; // Human readable output: the standard output, or the standard error when the JSON report goes there
+
+// Inputs of the primitives' benchmarks
+typedef struct {
+    const MapData *map;
+    VehicleStore *store;
+    Vector2 *points;     // QUERY_COUNT random points on the map
+    Rectangle *boxes;    // QUERY_COUNT player hitboxes on the road
+    const RoadRouter *router;
+    RoadSearch *search;
+    Vector2 *routes;     // QUERY_COUNT pairs of points on the road, for the path queries
+    volatile int sink;   // Keeps the compiler from dropping the calls
+} BenchContext;
+
+/*
+Saves a measurement for the JSON report
+Parameters: Measurement's name (*name), map's dimensions (mapWidth, mapHeight), number of vehicles (vehicles),
+number of threads (threads) and time per operation in nanoseconds (nsPerOp)
+*/
+static void saveResult(const char *name, int mapWidth, int mapHeight, int vehicles, int threads, double nsPerOp) {
+    if (resultCount == MAX_RESULTS) return;
+    BenchResult *result = &results[resultCount++];
+    snprintf(result->name, sizeof(result->name), "%s", name);
+    result->mapWidth = mapWidth;
+    result->mapHeight = mapHeight;
+    result->vehicles = vehicles;
+    result->threads = threads;
+    result->nsPerOp = nsPerOp;
+    result->opsPerSecond = 1e9 / nsPerOp;
+}
+
+/*
+Saves a measurement and prints it as a table row
+Parameters: Same as saveResult
+*/
+static void recordResult(const char *name, int mapWidth, int mapHeight, int vehicles, int threads, double nsPerOp) {
+    fprintf(tables, "  %-28s %5dx%-5d %7d veh %2d thr %14.1f ns/op %14.0f op/s\n", name, mapWidth, mapHeight, vehicles, threads, nsPerOp, 1e9 / nsPerOp);
+    saveResult(name, mapWidth, mapHeight, vehicles, threads, nsPerOp);
+}
+
+/*
+Builds a map of any size by tiling the shipped borders' image, so that the color mix stays realistic
+Parameters: Shipped map's pixels (*source), its dimensions (sourceWidth, sourceHeight) and the new dimensions (width, height)
+Returns: Pixels of the new map (must be freed)
+*/
+static Color *tileMap(const Color *source, int sourceWidth, int sourceHeight, int width, int height) {
+    Color *pixels = malloc((size_t)width * height * sizeof(Color));
+    for (int y = 0; y < height; y++) {
+        const Color *row = source + (size_t)(y % sourceHeight) * sourceWidth;
+        for (int x = 0; x < width; x++) pixels[(size_t)y * width + x] = row[x % sourceWidth];
+    }
+    return pixels;
+}
+
+/*
+Times every supported kernel of the map classification and checks that they agree with the scalar one
+Parameters: Map's pixels (*pixels) and dimensions (width, height)
+*/
+static void benchmarkClassify(const Color *pixels, int width, int height) {
+    int wordsPerRow = (width + 63) / 64;
+    size_t words = (size_t)wordsPerRow * height;
+    ClassifiedPixels reference = { malloc(words * 8), malloc(words * 8), malloc(words * 8) };
+    ClassifiedPixels out = { malloc(words * 8), malloc(words * 8), malloc(words * 8) };
+
+    ClassifyMapPixels(CLASSIFIER_SCALAR, pixels, width, height, wordsPerRow, reference);
+    fprintf(tables, "classify %dx%d (%.1f Mpx)\n", width, height, (double)width * height / 1e6);
+
+    ClassifierKind kinds[3] = { CLASSIFIER_SCALAR, CLASSIFIER_SSE2, CLASSIFIER_AVX2 };
+    for (int k = 0; k < 3; k++) {
+        if (!IsClassifierSupported(kinds[k])) {
+            fprintf(tables, "  %-6s  not supported on this CPU\n", GetClassifierName(kinds[k]));
+            continue;
+        }
+
+        double best = 1e30;
+        for (int run = 0; run < CLASSIFY_RUNS; run++) {
+            double start = GetPreciseTime();
+            ClassifyMapPixels(kinds[k], pixels, width, height, wordsPerRow, out);
+            double elapsed = GetPreciseTime() - start;
+            if (elapsed < best) best = elapsed;
+        }
+
+        bool same = memcmp(out.wallBits, reference.wallBits, words * 8) == 0 &&
+                    memcmp(out.restaurantBits, reference.restaurantBits, words * 8) == 0 &&
+                    memcmp(out.houseBits, reference.houseBits, words * 8) == 0;
+        fprintf(tables, "  %-6s  %8.2f ms  %8.1f Mpx/s  %s\n", GetClassifierName(kinds[k]), best * 1e3,
+                        (double)width * height / best / 1e6, same ? "ok" : "MISMATCH");
+
+        char name[48];
+        snprintf(name, sizeof(name), "classify %s (pixel)", GetClassifierName(kinds[k]));
+        saveResult(name, width, height, 0, 1, best * 1e9 / ((double)width * height));
+    }
+
+    free(reference.wallBits); free(reference.restaurantBits); free(reference.houseBits);
+    free(out.wallBits); free(out.restaurantBits); free(out.houseBits);
+}
+
+/*
+Times an operation: runs batches of it until MIN_BENCH_SECONDS have passed
+Parameters: Function that runs a batch (run), its context (*context) and operations per batch (batch)
+Returns: Time per operation in nanoseconds (double)
+*/
+static double timeOperation(void (*run)(BenchContext *context), BenchContext *context, int batch) {
+    run(context); // Warm up the caches
+    long long operations = 0;
+    double start = GetPreciseTime();
+    double elapsed;
+    do {
+        run(context);
+        operations += batch;
+        elapsed = GetPreciseTime() - start;
+    } while (elapsed < MIN_BENCH_SECONDS);
+    return elapsed * 1e9 / operations;
+}
+
+/*
+Batch: willTouchBorder at every random point
+Parameter: Pointer to the context (*context)
+*/
+static void runWillTouchBorder(BenchContext *context) {
+    int hits = 0;
+    for (int i = 0; i < QUERY_COUNT; i++) hits += willTouchBorder(context->map, context->points[i]);
+    context->sink = hits;
+}
+
+/*
+Batch: isVehiclePositionValid at every random point, cycling through the vehicle types and rotations
+Parameter: Pointer to the context (*context)
+*/
+static void runIsVehiclePositionValid(BenchContext *context) {
+    int hits = 0;
+    for (int i = 0; i < QUERY_COUNT; i++) {
+        hits += isVehiclePositionValid(context->map, context->points[i].x, context->points[i].y, (TYPE_OF_VEHICLE)(i % 3), (i & 3) * 90);
+    }
+    context->sink = hits;
+}
+
+/*
+Batch: checkCollisionWithVehicles for every random hitbox
+Parameter: Pointer to the context (*context)
+*/
+static void runCheckCollision(BenchContext *context) {
+    int hits = 0;
+    for (int i = 0; i < QUERY_COUNT; i++) hits += checkCollisionWithVehicles(context->boxes[i], context->store, true);
+    context->sink = hits;
+}
+
+/*
+Batch: 64 respawn positions
+Parameter: Pointer to the context (*context)
+*/
+static void runGetRandomValidPosition(BenchContext *context) {
+    float sum = 0;
+    for (int i = 0; i < 64; i++) sum += GetRandomValidPosition(context->map, context->store).x;
+    context->sink = (int)sum;
+}
+
+/*
+Batch: one traffic update
+Parameter: Pointer to the context (*context)
+*/
+static void runUpdateTraffic(BenchContext *context) {
+    updateTraffic(context->store, context->map, (Vector2){ -1000, -1000 }); // No player to wait for
+}
+
+/*
+Batch: finds the map's buildings from scratch
+Parameter: Pointer to the context (*context)
+*/
+static void runInitMapLocations(BenchContext *context) {
+    InitMapLocations(context->map);
+    context->sink = restaurantCount + houseCount;
+}
+
+/*
+Batch: finds the road nearest to every random point
+Parameter: Pointer to the context (*context)
+*/
+static void runFindNearestRoad(BenchContext *context) {
+    RoadPosition road;
+    int hits = 0;
+    for (int i = 0; i < QUERY_COUNT; i++) hits += FindNearestRoad(context->router, context->points[i], &road);
+    context->sink = hits;
+}
+
+/*
+Batch: a path query between every pair of road points
+Parameter: Pointer to the context (*context)
+*/
+static void runFindRoadPath(BenchContext *context) {
+    float sum = 0;
+    for (int i = 0; i < QUERY_COUNT; i++) sum += FindRoadPath(context->router, context->search, context->routes[2 * i], context->routes[2 * i + 1]);
+    context->sink = (int)sum;
+}
+
+/*
+Batch: measures the road distance from every restaurant to every house
+Parameter: Pointer to the context (*context)
+*/
+static void runInitDeliveryDistances(BenchContext *context) {
+    InitDeliveryDistances(context->map);
+    context->sink = (int)deliveryDistances[0];
+}
+
+/*
+Fills a store with vehicles the way the game does, always the same ones (fixed seed)
+Parameters: Pointer to the store (*store), number of vehicles (count) and pointer to map's data (*map)
+*/
+static void spawnTraffic(VehicleStore *store, int count, const MapData *map) {
+    SetRandomSeed(TRAFFIC_SEED);
+    vehicleGenerator(store, count, map, (Vector2){ -1000, -1000 });
+}
+
+/*
+Times the collision and traffic primitives on one map, for every number of vehicles
+Parameters: Pointer to map's data (*map), numbers of vehicles to sweep (*vehicleCounts, countCount)
+*/
+static void benchmarkPrimitives(const MapData *map, const int *vehicleCounts, int countCount) {
+    int threads = GetJobWorkerCount() + 1;
+    BenchContext context = { map, NULL, malloc(QUERY_COUNT * sizeof(Vector2)), malloc(QUERY_COUNT * sizeof(Rectangle)), NULL, NULL, NULL, 0 };
+
+    // Points anywhere on the map for the wall checks, hitboxes on the road for the vehicle checks
+    SetRandomSeed(TRAFFIC_SEED);
+    for (int i = 0; i < QUERY_COUNT; i++) {
+        context.points[i] = (Vector2){ GetRandomValue(0, map->width - 1), GetRandomValue(0, map->height - 1) };
+        Vector2 road = { map->width / 2.0f, map->height / 2.0f };
+        GetRandomPosePosition(map, POSE_CAR_VERTICAL, &road);
+        context.boxes[i] = (Rectangle){ road.x, road.y, 20, 20 };
+    }
+
+    fprintf(tables, "primitives on %dx%d\n", map->width, map->height);
+    recordResult("InitMapLocations", map->width, map->height, 0, threads, timeOperation(runInitMapLocations, &context, 1));
+    recordResult("willTouchBorder", map->width, map->height, 0, threads, timeOperation(runWillTouchBorder, &context, QUERY_COUNT));
+    recordResult("isVehiclePositionValid", map->width, map->height, 0, threads, timeOperation(runIsVehiclePositionValid, &context, QUERY_COUNT));
+
+    for (int c = 0; c < countCount; c++) {
+        VehicleStore store = LoadVehicleStore(vehicleCounts[c], map->width, map->height);
+        spawnTraffic(&store, vehicleCounts[c], map);
+        context.store = &store;
+
+        recordResult("checkCollisionWithVehicles", map->width, map->height, store.count, threads, timeOperation(runCheckCollision, &context, QUERY_COUNT));
+        recordResult("GetRandomValidPosition", map->width, map->height, store.count, threads, timeOperation(runGetRandomValidPosition, &context, 64));
+        double perStep = timeOperation(runUpdateTraffic, &context, 1);
+        recordResult("updateTraffic (step)", map->width, map->height, store.count, threads, perStep);
+        recordResult("updateTraffic (vehicle)", map->width, map->height, store.count, threads, perStep / store.count);
+
+        UnloadVehicleStore(&store);
+    }
+
+    free(context.points);
+    free(context.boxes);
+}
+
+/*
+Times the road network's queries: snapping a position to the road, the restaurant to house distance table and shortest paths
+between random road points, with the plain straight-line estimate (A*) and with landmarks (ALT). Checks that both find paths
+of the same length
+Parameter: Pointer to map's data (*map), with the buildings found on it
+*/
+static void benchmarkRoutes(const MapData *map) {
+    BenchContext context = { map, NULL, malloc(QUERY_COUNT * sizeof(Vector2)), NULL, NULL, NULL, malloc(2 * QUERY_COUNT * sizeof(Vector2)), 0 };
+    SetRandomSeed(TRAFFIC_SEED);
+    for (int i = 0; i < QUERY_COUNT; i++) {
+        context.points[i] = (Vector2){ GetRandomValue(0, map->width - 1), GetRandomValue(0, map->height - 1) };
+        // Tiled maps split into separate networks. Pairs are drawn from the same one, so that every query searches
+        uint32_t component[2] = { 0, 1 };
+        for (int tries = 0; tries < 64 && component[0] != component[1]; tries++) {
+            for (int end = 0; end < 2; end++) {
+                RoadPosition road;
+                context.routes[2 * i + end] = (Vector2){ map->width / 2.0f, map->height / 2.0f };
+                GetRandomPosePosition(map, POSE_CAR_VERTICAL, &context.routes[2 * i + end]);
+                component[end] = FindNearestRoad(&map->router, context.routes[2 * i + end], &road) ?
+                                 map->router.component[map->roads.segments[road.segment].nodes[0]] : (uint32_t)end;
+            }
+        }
+    }
+
+    fprintf(tables, "routes on %dx%d (%d nodes, %d segments)\n", map->width, map->height, map->roads.nodeCount, map->roads.segmentCount);
+    double start = GetPreciseTime();
+    RoadRouter plain = BuildRoadRouter(map->roads, 0);
+    RoadRouter landmarks = BuildRoadRouter(map->roads, ROUTER_LANDMARKS);
+    recordResult("BuildRoadRouter", map->width, map->height, 0, 1, (GetPreciseTime() - start) * 1e9);
+
+    context.router = &landmarks;
+    recordResult("FindNearestRoad", map->width, map->height, 0, 1, timeOperation(runFindNearestRoad, &context, QUERY_COUNT));
+    if (restaurantCount > 0 && houseCount > 0) {
+        recordResult("InitDeliveryDistances", map->width, map->height, 0, GetJobWorkerCount() + 1, timeOperation(runInitDeliveryDistances, &context, 1));
+    }
+
+    // Both routers must agree on every length. The settled nodes show how much of the graph each one searches
+    RoadSearch search = LoadRoadSearch(&landmarks);
+    context.search = &search;
+    long long settled[2] = { 0, 0 };
+    int mismatches = 0;
+    for (int i = 0; i < QUERY_COUNT; i++) {
+        float plainLength = FindRoadPath(&plain, &search, context.routes[2 * i], context.routes[2 * i + 1]);
+        settled[0] += search.settled;
+        float landmarkLength = FindRoadPath(&landmarks, &search, context.routes[2 * i], context.routes[2 * i + 1]);
+        settled[1] += search.settled;
+        if (fabsf(plainLength - landmarkLength) > 1e-3f * (1.0f + fabsf(plainLength))) mismatches++;
+    }
+
+    context.router = &plain;
+    recordResult("FindRoadPath (A*)", map->width, map->height, 0, 1, timeOperation(runFindRoadPath, &context, QUERY_COUNT));
+    context.router = &landmarks;
+    recordResult("FindRoadPath (ALT)", map->width, map->height, 0, 1, timeOperation(runFindRoadPath, &context, QUERY_COUNT));
+    fprintf(tables, "  settled nodes per query: A* %.1f, ALT %.1f  %s\n", (double)settled[0] / QUERY_COUNT, (double)settled[1] / QUERY_COUNT,
+                    mismatches == 0 ? "ok" : "MISMATCH");
+
+    UnloadRoadSearch(&search);
+    UnloadRoadRouter(&plain);
+    UnloadRoadRouter(&landmarks);
+    free(context.points);
+    free(context.routes);
+}
+
+/*
+Hashes the vehicles' positions and headings (FNV-1a), to check that runs with different numbers of threads agree
+Parameter: Pointer to the store (*store)
+Returns: The hash (uint64_t)
+*/
+static uint64_t hashTraffic(const VehicleStore *store) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; i < store->count; i++) {
+        float state[4] = { store->x[i], store->y[i], store->dirX[i], store->dirY[i] };
+        const unsigned char *bytes = (const unsigned char *)state;
+        for (size_t b = 0; b < sizeof(state); b++) hash = (hash ^ bytes[b]) * 1099511628211ULL;
+        hash = (hash ^ store->slotOf[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/*
+Times the traffic update with 1, 2, 4... threads (up to the CPU's cores) and checks that every run ends in the same state as the single threaded one.
+Leaves the job system stopped
+Parameters: Pointer to map's data (*map) and number of vehicles (count)
+*/
+static void benchmarkTraffic(const MapData *map, int count) {
+    int maxThreads = GetProcessorCount();
+    if (maxThreads > MAX_JOB_WORKERS + 1) maxThreads = MAX_JOB_WORKERS + 1;
+    Vector2 farAway = { -1000, -1000 }; // No player to wait for
+    uint64_t reference = 0;
+    double single = 0;
+
+    ShutdownJobSystem();
+    fprintf(tables, "traffic %d vehicles, %d steps\n", count, TRAFFIC_STEPS);
+    for (int threads = 1;; threads *= 2) {
+        if (threads > maxThreads) threads = maxThreads; // Always end with every core
+        InitJobSystem(threads);
+        VehicleStore store = LoadVehicleStore(count, map->width, map->height);
+        spawnTraffic(&store, count, map);
+        for (int step = 0; step < TRAFFIC_WARMUP_STEPS; step++) updateTraffic(&store, map, farAway);
+
+        double start = GetPreciseTime();
+        for (int step = 0; step < TRAFFIC_STEPS; step++) updateTraffic(&store, map, farAway);
+        double perStep = (GetPreciseTime() - start) / TRAFFIC_STEPS;
+
+        uint64_t hash = hashTraffic(&store);
+        if (threads == 1) {
+            reference = hash;
+            single = perStep;
+        }
+        fprintf(tables, "  %2d threads  %8.2f ms/step  %5.2fx  %s\n", threads, perStep * 1e3, single / perStep, hash == reference ? "ok" : "MISMATCH");
+        saveResult("updateTraffic (threads)", map->width, map->height, count, threads, perStep * 1e9);
+
+        UnloadVehicleStore(&store);
+        ShutdownJobSystem();
+        if (threads == maxThreads) break;
+    }
+}
+
+/*
+Writes a string as a JSON string literal, escaping quotes, backslashes and control characters
+Parameters: File to write to (*file) and the string (*text)
+*/
+static void writeJsonString(FILE *file, const char *text) {
+    fputc('"', file);
+    for (const unsigned char *c = (const unsigned char *)text; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') fprintf(file, "\\%c", *c);
+        else if (*c < 0x20) fprintf(file, "\\u%04x", *c);
+        else fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+/*
+Sends raylib's log to the standard error, so that it doesn't mix with a JSON report on the standard output
+Parameters: Log level (logLevel), format (*text) and its arguments (args)
+*/
+static void logToStderr(int logLevel, const char *text, va_list args) {
+    (void)logLevel;
+    vfprintf(stderr, text, args);
+    fputc('\n', stderr);
+}
+
+/*
+Writes every measurement to a JSON file, to compare runs across commits
+Parameters: File's path (*path), "-" for the standard output, and a label for the run, e.g. a commit hash (*label)
+Returns: true on success. Otherwise, false
+*/
+static bool writeReport(const char *path, const char *label) {
+    FILE *file = (strcmp(path, "-") == 0) ? stdout : fopen(path, "w");
+    if (file == NULL) return false;
+
+    fprintf(file, "{\n  \"label\": ");
+    writeJsonString(file, label);
+    fprintf(file, ",\n  \"cpus\": %d,\n  \"classifier\": \"%s\",\n  \"results\": [\n", GetProcessorCount(), GetClassifierName(CLASSIFIER_BEST));
+    for (int i = 0; i < resultCount; i++) {
+        const BenchResult *r = &results[i];
+        fprintf(file, "    { \"name\": ");
+        writeJsonString(file, r->name);
+        fprintf(file, ", \"map\": \"%dx%d\", \"vehicles\": %d, \"threads\": %d, \"ns_per_op\": %.3f, \"ops_per_s\": %.3f }%s\n",
+                r->mapWidth, r->mapHeight, r->vehicles, r->threads, r->nsPerOp, r->opsPerSecond, (i + 1 < resultCount) ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    return (file == stdout) ? true : fclose(file) == 0;
+}
+
+/*
+Reads a comma separated list of numbers
+Parameters: The list (*text), array to fill (*values) and its size (maxValues)
+Returns: Number of values read (int)
+*/
+static int parseList(const char *text, int *values, int maxValues) {
+    int count = 0;
+    while (*text != '\0' && count < maxValues) {
+        char *end;
+        long value = strtol(text, &end, 10);
+        if (end == text) break;
+        if (value > 0) values[count++] = (int)value;
+        text = (*end == ',') ? end + 1 : end;
+    }
+    return count;
+}
+
+/* Benchmark's main function
+Usage: Benchmark [width height] [--vehicles a,b,...] [--scales a,b,...] [--json file] [--label text]
+Classifies the shipped map and, optionally, a tiled map of the given size. Then times the collision and traffic primitives
+and the road network's path queries for every number of vehicles on the shipped map tiled scale x scale times,
+and the traffic update for every number of threads.
+--json saves every measurement ("-" for the standard output, the tables and the log then go to the standard error)
+*/
+int main(int argc, char **argv) {
+    SetTraceLogLevel(LOG_WARNING);
+
+    int vehicleCounts[MAX_SWEEP];
+    int countCount = sizeof(DEFAULT_VEHICLE_COUNTS) / sizeof(DEFAULT_VEHICLE_COUNTS[0]);
+    memcpy(vehicleCounts, DEFAULT_VEHICLE_COUNTS, sizeof(DEFAULT_VEHICLE_COUNTS));
+    int scales[MAX_SWEEP];
+    int scaleCount = sizeof(DEFAULT_MAP_SCALES) / sizeof(DEFAULT_MAP_SCALES[0]);
+    memcpy(scales, DEFAULT_MAP_SCALES, sizeof(DEFAULT_MAP_SCALES));
+    const char *jsonPath = NULL;
+    const char *label = "";
+    int width = 0, height = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--vehicles") == 0 && i + 1 < argc) countCount = parseList(argv[++i], vehicleCounts, MAX_SWEEP);
+        else if (strcmp(argv[i], "--scales") == 0 && i + 1 < argc) scaleCount = parseList(argv[++i], scales, MAX_SWEEP);
+        else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) jsonPath = argv[++i];
+        else if (strcmp(argv[i], "--label") == 0 && i + 1 < argc) label = argv[++i];
+        else if (width == 0) width = atoi(argv[i]);
+        else if (height == 0) height = atoi(argv[i]);
+    }
+
+    tables = stdout;
+    if (jsonPath != NULL && strcmp(jsonPath, "-") == 0) {
+        tables = stderr;
+        SetTraceLogCallback(logToStderr);
+    }
+
+    Image borders = LoadImage(BORDERS_PATH);
+    if (borders.data == NULL) {
+        fprintf(stderr, "Could not load %s\n", BORDERS_PATH);
+        return 1;
+    }
+    ImageFormat(&borders, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    const Color *pixels = borders.data;
+
+    benchmarkClassify(pixels, borders.width, borders.height);
+    if (width > 0 && height > 0) {
+        Color *tiled = tileMap(pixels, borders.width, borders.height, width, height);
+        benchmarkClassify(tiled, width, height);
+        free(tiled);
+    }
+
+    // Bigger maps are the shipped one tiled, so that roads and buildings keep their density
+    InitJobSystem(0);
+    for (int s = 0; s < scaleCount; s++) {
+        Image image = borders;
+        if (scales[s] > 1) {
+            image.width = borders.width * scales[s];
+            image.height = borders.height * scales[s];
+            image.data = tileMap(pixels, borders.width, borders.height, image.width, image.height);
+        }
+
+        MapData map = LoadMapData(image);
+        InitMapLocations(&map);
+        InitTrafficDestinations(&map); // Traffic heads for the buildings, as in the game
+        benchmarkPrimitives(&map, vehicleCounts, countCount);
+        benchmarkRoutes(&map);
+        UnloadMapLocations();
+        UnloadMapData(&map);
+        if (image.data != borders.data) free(image.data);
+    }
+
+    MapData map = LoadMapData(borders);
+    InitMapLocations(&map);
+    InitTrafficDestinations(&map);
+    benchmarkTraffic(&map, TRAFFIC_VEHICLES);
+    UnloadMapLocations();
+    UnloadMapData(&map);
+    UnloadImage(borders);
+
+    if (jsonPath != NULL && !writeReport(jsonPath, label)) {
+        fprintf(stderr, "Could not write %s\n", jsonPath);
+        return 1;
+    }
+    return 0;
+}
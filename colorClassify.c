@@ -0,0 +1,217 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+#include <string.h>
+#include "raylib.h"
+#include "colorClassify.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+    #define CLASSIFY_X86
+    #include <immintrin.h>
+#endif
+
+// Every predicate is "channel > min" and "channel < max" for each of R, G, B, A.
+// Thresholds are stored inclusive (min + 1, max - 1) so that the SIMD kernels can use unsigned min/max
+typedef struct {
+    unsigned char atLeast[4];
+    unsigned char atMost[4];
+} ColorRange;
+
+static const ColorRange wallRange = { { 151, 0, 0, 0 }, { 255, 99, 99, 255 } };         // r > 150, g < 100, b < 100
+static const ColorRange restaurantRange = { { 0, 201, 0, 0 }, { 99, 255, 99, 255 } };   // g > 200, r < 100, b < 100
+static const ColorRange houseRange = { { 0, 0, 201, 0 }, { 255, 29, 255, 255 } };       // b > 200, g < 30
+
+/*
+Checks if a color lies in a range
+Parameters: Pixel's color (c) and pointer to the range (*range)
+Returns: true if inside. Otherwise, false
+*/
+static bool inRange(Color c, const ColorRange *range) {
+    return c.r >= range->atLeast[0] && c.r <= range->atMost[0] &&
+           c.g >= range->atLeast[1] && c.g <= range->atMost[1] &&
+           c.b >= range->atLeast[2] && c.b <= range->atMost[2] &&
+           c.a >= range->atLeast[3] && c.a <= range->atMost[3];
+}
+
+/*
+Classifies pixels one at a time
+Parameters: Pixels of one row (*row), first and last pixel (from, to) and the three bitset rows to fill
+*/
+static void classifyScalar(const Color *row, int from, int to, uint64_t *wall, uint64_t *restaurant, uint64_t *house) {
+    for (int x = from; x < to; x++) {
+        uint64_t bit = 1ULL << (x & 63);
+        if (inRange(row[x], &wallRange)) wall[x >> 6] |= bit;
+        if (inRange(row[x], &restaurantRange)) restaurant[x >> 6] |= bit;
+        if (inRange(row[x], &houseRange)) house[x >> 6] |= bit;
+    }
+}
+
+#ifdef CLASSIFY_X86
+
+/*
+Packs a range's thresholds into one 32-bit lane (a whole RGBA pixel)
+Parameter: Thresholds (bytes[4])
+Returns: Lane's value (int)
+*/
+static int packLane(const unsigned char bytes[4]) {
+    return (int)((unsigned)bytes[0] | (unsigned)bytes[1] << 8 | (unsigned)bytes[2] << 16 | (unsigned)bytes[3] << 24);
+}
+
+/*
+Tests 4 RGBA pixels at once: a byte is inside if max(v, atLeast) == v and min(v, atMost) == v
+Parameters: 4 pixels (v) and the range's thresholds (atLeast, atMost)
+Returns: One bit per pixel inside the range
+*/
+static inline unsigned testSSE2(__m128i v, __m128i atLeast, __m128i atMost) {
+    __m128i ok = _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(v, atLeast), v), _mm_cmpeq_epi8(_mm_min_epu8(v, atMost), v));
+    return (unsigned)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(ok, _mm_set1_epi32(-1))));
+}
+
+/*
+Classifies whole 64-pixel words of a row with SSE2 (4 pixels per vector)
+Parameters: Pixels of one row (*row), number of whole words (words) and the three bitset rows to fill
+*/
+static void classifySSE2(const Color *row, int words, uint64_t *wall, uint64_t *restaurant, uint64_t *house) {
+    const __m128i wallMin = _mm_set1_epi32(packLane(wallRange.atLeast)), wallMax = _mm_set1_epi32(packLane(wallRange.atMost));
+    const __m128i restMin = _mm_set1_epi32(packLane(restaurantRange.atLeast)), restMax = _mm_set1_epi32(packLane(restaurantRange.atMost));
+    const __m128i houseMin = _mm_set1_epi32(packLane(houseRange.atLeast)), houseMax = _mm_set1_epi32(packLane(houseRange.atMost));
+
+    for (int i = 0; i < words; i++) {
+        const Color *p = row + i * 64;
+        uint64_t w = 0, r = 0, h = 0;
+
+        for (int j = 0; j < 64; j += 4) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(p + j));
+            w |= (uint64_t)testSSE2(v, wallMin, wallMax) << j;
+            r |= (uint64_t)testSSE2(v, restMin, restMax) << j;
+            h |= (uint64_t)testSSE2(v, houseMin, houseMax) << j;
+        }
+        wall[i] = w;
+        restaurant[i] = r;
+        house[i] = h;
+    }
+}
+
+/*
+Tests 8 RGBA pixels at once, same as testSSE2
+Parameters: 8 pixels (v) and the range's thresholds (atLeast, atMost)
+Returns: One bit per pixel inside the range
+*/
+__attribute__((target("avx2")))
+static inline unsigned testAVX2(__m256i v, __m256i atLeast, __m256i atMost) {
+    __m256i ok = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(v, atLeast), v), _mm256_cmpeq_epi8(_mm256_min_epu8(v, atMost), v));
+    return (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(ok, _mm256_set1_epi32(-1))));
+}
+
+/*
+Classifies whole 64-pixel words of a row with AVX2 (8 pixels per vector)
+Parameters: Pixels of one row (*row), number of whole words (words) and the three bitset rows to fill
+*/
+__attribute__((target("avx2")))
+static void classifyAVX2(const Color *row, int words, uint64_t *wall, uint64_t *restaurant, uint64_t *house) {
+    const __m256i wallMin = _mm256_set1_epi32(packLane(wallRange.atLeast)), wallMax = _mm256_set1_epi32(packLane(wallRange.atMost));
+    const __m256i restMin = _mm256_set1_epi32(packLane(restaurantRange.atLeast)), restMax = _mm256_set1_epi32(packLane(restaurantRange.atMost));
+    const __m256i houseMin = _mm256_set1_epi32(packLane(houseRange.atLeast)), houseMax = _mm256_set1_epi32(packLane(houseRange.atMost));
+
+    for (int i = 0; i < words; i++) {
+        const Color *p = row + i * 64;
+        uint64_t w = 0, r = 0, h = 0;
+
+        for (int j = 0; j < 64; j += 8) {
+            __m256i v = _mm256_loadu_si256((const __m256i *)(p + j));
+            w |= (uint64_t)testAVX2(v, wallMin, wallMax) << j;
+            r |= (uint64_t)testAVX2(v, restMin, restMax) << j;
+            h |= (uint64_t)testAVX2(v, houseMin, houseMax) << j;
+        }
+        wall[i] = w;
+        restaurant[i] = r;
+        house[i] = h;
+    }
+}
+
+#endif
+
+/*
+Checks if a kernel can run on this CPU
+Parameter: Kernel (kind)
+Returns: true if supported. Otherwise, false
+*/
+bool IsClassifierSupported(ClassifierKind kind) {
+    switch (kind) {
+        case CLASSIFIER_BEST:
+        case CLASSIFIER_SCALAR:
+            return true;
+#ifdef CLASSIFY_X86
+        case CLASSIFIER_SSE2:
+            return true;
+        case CLASSIFIER_AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+/*
+Resolves CLASSIFIER_BEST (and unsupported kernels) to the kernel that will actually run
+Parameter: Requested kernel (kind)
+Returns: Kernel to run (ClassifierKind)
+*/
+static ClassifierKind resolveClassifier(ClassifierKind kind) {
+    if (kind != CLASSIFIER_BEST && IsClassifierSupported(kind)) return kind;
+    if (IsClassifierSupported(CLASSIFIER_AVX2)) return CLASSIFIER_AVX2;
+    if (IsClassifierSupported(CLASSIFIER_SSE2)) return CLASSIFIER_SSE2;
+    return CLASSIFIER_SCALAR;
+}
+
+/*
+Finds the name of a kernel, for logs and benchmarks
+Parameter: Kernel (kind)
+Returns: Name of the kernel that runs for the given kind
+*/
+const char *GetClassifierName(ClassifierKind kind) {
+    switch (resolveClassifier(kind)) {
+        case CLASSIFIER_AVX2: return "AVX2";
+        case CLASSIFIER_SSE2: return "SSE2";
+        default: return "scalar";
+    }
+}
+
+/*
+Classifies every pixel of the map as wall, restaurant and house in a single pass
+Parameters: Kernel to use (kind), RGBA pixels (*pixels), map's dimensions (width, height),
+64-bit words per bitset row (wordsPerRow) and the bitsets to fill (out)
+*/
+void ClassifyMapPixels(ClassifierKind kind, const Color *pixels, int width, int height, int wordsPerRow, ClassifiedPixels out) {
+    kind = resolveClassifier(kind);
+    int wholeWords = (kind == CLASSIFIER_SCALAR) ? 0 : width / 64;
+
+    for (int y = 0; y < height; y++) {
+        const Color *row = pixels + (size_t)y * width;
+        size_t offset = (size_t)y * wordsPerRow;
+        uint64_t *wall = out.wallBits + offset;
+        uint64_t *restaurant = out.restaurantBits + offset;
+        uint64_t *house = out.houseBits + offset;
+
+        memset(wall, 0, wordsPerRow * sizeof(uint64_t));
+        memset(restaurant, 0, wordsPerRow * sizeof(uint64_t));
+        memset(house, 0, wordsPerRow * sizeof(uint64_t));
+
+#ifdef CLASSIFY_X86
+        if (kind == CLASSIFIER_AVX2) classifyAVX2(row, wholeWords, wall, restaurant, house);
+        else if (kind == CLASSIFIER_SSE2) classifySSE2(row, wholeWords, wall, restaurant, house);
+#endif
+        // The rest of the row (or all of it without SIMD)
+        classifyScalar(row, wholeWords * 64, width, wall, restaurant, house);
+    }
+}
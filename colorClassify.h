@@ -0,0 +1,34 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+#ifndef COLORCLASSIFY_H
+#define COLORCLASSIFY_H
+
+#include <stdint.h>
+#include "raylib.h"
+
+// Implementations of the classification kernel. CLASSIFIER_BEST picks the fastest one the CPU supports
+typedef enum { CLASSIFIER_BEST, CLASSIFIER_SCALAR, CLASSIFIER_SSE2, CLASSIFIER_AVX2 } ClassifierKind;
+
+// Output of one pass over the map: 1 bit per pixel, rows aligned to 64-bit words
+typedef struct {
+    uint64_t *wallBits;       // "Too red" pixels
+    uint64_t *restaurantBits; // Green pixels
+    uint64_t *houseBits;      // Blue pixels
+} ClassifiedPixels;
+
+// functions
+bool IsClassifierSupported(ClassifierKind kind);
+const char *GetClassifierName(ClassifierKind kind);
+void ClassifyMapPixels(ClassifierKind kind, const Color *pixels, int width, int height, int wordsPerRow, ClassifiedPixels out);
+
+#endif
@@ -0,0 +1,286 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "raylib.h"
+#include "flowField.h"
+
+// --- FLOW FIELD CONSTANTS ---
+static const int FLOW_COMFORT_CLEARANCE = 6; // Cells closer than this to a wall cost more, so that routes keep to the middle of the road
+static const float FLOW_WALL_PENALTY = 0.5f;   // Extra cost per pixel of clearance missing
+static const int STEP_X[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+static const int STEP_Y[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+
+// Priority queue entry of the field's Dijkstra
+typedef struct {
+    float cost;
+    int32_t cell;
+} FlowQueueItem;
+
+// Growable binary heap (smallest cost on top)
+typedef struct {
+    FlowQueueItem *items;
+    int count;
+    int capacity;
+} FlowQueue;
+
+/*
+Adds an entry to the heap, growing it when full
+Parameters: Pointer to the heap (*queue) and the entry (item)
+*/
+static void pushFlow(FlowQueue *queue, FlowQueueItem item) {
+    if (queue->count == queue->capacity) {
+        queue->capacity = (queue->capacity > 0) ? queue->capacity * 2 : 4096;
+        queue->items = realloc(queue->items, queue->capacity * sizeof(FlowQueueItem));
+    }
+    int i = queue->count++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (queue->items[parent].cost <= item.cost) break;
+        queue->items[i] = queue->items[parent];
+        i = parent;
+    }
+    queue->items[i] = item;
+}
+
+/*
+Removes the top entry of the heap
+Parameter: Pointer to the heap (*queue), not empty
+Returns: The entry with the smallest cost (FlowQueueItem)
+*/
+static FlowQueueItem popFlow(FlowQueue *queue) {
+    FlowQueueItem top = queue->items[0];
+    FlowQueueItem last = queue->items[--queue->count];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= queue->count) break;
+        if (child + 1 < queue->count && queue->items[child + 1].cost < queue->items[child].cost) child++;
+        if (last.cost <= queue->items[child].cost) break;
+        queue->items[i] = queue->items[child];
+        i = child;
+    }
+    queue->items[i] = last;
+    return top;
+}
+
+/*
+Writes a cell of a packed field
+Parameters: The field's nibbles (*directions), cell's index (cell) and its direction (direction)
+*/
+static void setFlow(uint8_t *directions, int32_t cell, FlowDirection direction) {
+    uint8_t *byte = &directions[cell >> 1];
+    if (cell & 1) *byte = (uint8_t)((*byte & 0x0F) | (direction << 4));
+    else *byte = (uint8_t)((*byte & 0xF0) | direction);
+}
+
+/*
+Reads a cell of a packed field
+Parameters: The field's nibbles (*directions) and cell's index (cell)
+Returns: Cell's direction (FlowDirection)
+*/
+static FlowDirection getFlow(const uint8_t *directions, int32_t cell) {
+    return (FlowDirection)((directions[cell >> 1] >> ((cell & 1) * 4)) & 0x0F);
+}
+
+/*
+Finds the clearance at a cell's center
+Parameters: Pointer to the field (*field), pointer to map's data (*map) and cell's coordinates (cx, cy)
+Returns: Distance to the nearest wall (int), 0 for walls and cells outside the field
+*/
+static int getFlowClearance(const FlowField *field, const MapData *map, int cx, int cy) {
+    if (cx < 0 || cy < 0 || cx >= field->columns || cy >= field->rows) return 0;
+    return GetWallDistance(map, cx * FLOW_CELL_SIZE + FLOW_CELL_SIZE / 2, cy * FLOW_CELL_SIZE + FLOW_CELL_SIZE / 2);
+}
+
+/*
+Finds the cell of a position, clamped to the field
+Parameters: Pointer to the field (*field) and the position (position)
+Returns: Cell's index (int32_t)
+*/
+static int32_t findFlowCell(const FlowField *field, Vector2 position) {
+    int cx = (int)(position.x / FLOW_CELL_SIZE);
+    int cy = (int)(position.y / FLOW_CELL_SIZE);
+    if (cx < 0) cx = 0;
+    if (cy < 0) cy = 0;
+    if (cx >= field->columns) cx = field->columns - 1;
+    if (cy >= field->rows) cy = field->rows - 1;
+    return (int32_t)cy * field->columns + cx;
+}
+
+/*
+Job: fills nextDirections with a reverse Dijkstra from nextTarget. Steps go to the 8 neighbours that aren't walls
+(diagonals cost sqrt(2) and may not cut a wall's corner), cost more close to the walls, and every cell points to the
+neighbour it was reached from. If the target's cell is a wall, the search starts from the nearest point of the road network
+Parameter: Pointer to the field (FlowField *)
+*/
+static void buildFlowField(void *data) {
+    FlowField *field = data;
+    const MapData *map = field->map;
+    int32_t cells = (int32_t)field->columns * field->rows;
+    float *cost = malloc(cells * sizeof(float));
+    for (int32_t c = 0; c < cells; c++) cost[c] = INFINITY;
+    memset(field->nextDirections, 0xFF, ((size_t)cells + 1) / 2); // FLOW_NONE everywhere
+    FlowQueue queue = {0};
+
+    int32_t seed = findFlowCell(field, field->nextTarget);
+    RoadPosition road;
+    if (getFlowClearance(field, map, seed % field->columns, seed / field->columns) == 0 && FindNearestRoad(&map->router, field->nextTarget, &road)) {
+        seed = findFlowCell(field, road.point);
+    }
+    cost[seed] = 0;
+    setFlow(field->nextDirections, seed, FLOW_TARGET);
+    pushFlow(&queue, (FlowQueueItem){ 0, seed });
+
+    while (queue.count > 0) {
+        FlowQueueItem item = popFlow(&queue);
+        if (item.cost > cost[item.cell]) continue; // Stale, the cell was reached for less since
+        int cx = item.cell % field->columns;
+        int cy = item.cell / field->columns;
+
+        for (int d = 0; d < 8; d++) {
+            int nx = cx + STEP_X[d];
+            int ny = cy + STEP_Y[d];
+            int clearance = getFlowClearance(field, map, nx, ny);
+            if (clearance == 0) continue;
+            bool diagonal = (d & 1) != 0;
+            if (diagonal && (getFlowClearance(field, map, nx, cy) == 0 || getFlowClearance(field, map, cx, ny) == 0)) continue;
+
+            int32_t next = (int32_t)ny * field->columns + nx;
+            float penalty = (clearance < FLOW_COMFORT_CLEARANCE) ? (FLOW_COMFORT_CLEARANCE - clearance) * FLOW_WALL_PENALTY : 0.0f;
+            float nextCost = item.cost + (diagonal ? 1.41421356f : 1.0f) * (1.0f + penalty);
+            if (nextCost >= cost[next]) continue;
+            cost[next] = nextCost;
+            setFlow(field->nextDirections, next, (FlowDirection)((d + 4) & 7)); // Back the way the search came
+            pushFlow(&queue, (FlowQueueItem){ nextCost, next });
+        }
+    }
+
+    free(queue.items);
+    free(cost);
+}
+
+/*
+Allocates a flow field for a map, with no target yet
+Parameters: Map's dimensions in pixels (mapWidth, mapHeight)
+Returns: The field (FlowField). Must be freed with UnloadFlowField
+*/
+FlowField LoadFlowField(int mapWidth, int mapHeight) {
+    FlowField field = {0};
+    field.columns = (mapWidth + FLOW_CELL_SIZE - 1) / FLOW_CELL_SIZE;
+    field.rows = (mapHeight + FLOW_CELL_SIZE - 1) / FLOW_CELL_SIZE;
+    size_t bytes = ((size_t)field.columns * field.rows + 1) / 2;
+    field.directions = malloc(bytes);
+    field.nextDirections = malloc(bytes);
+    field.target = (Vector2){ -1, -1 };
+    return field;
+}
+
+/*
+Frees a flow field, after its rebuild (if any) is done
+Parameter: Pointer to the field (*field)
+*/
+void UnloadFlowField(FlowField *field) {
+    if (field->building) WaitForJob(&field->job);
+    free(field->directions);
+    free(field->nextDirections);
+    *field = (FlowField){0};
+}
+
+/*
+Waits for the field's rebuild, if any, and switches to its result
+Parameter: Pointer to the field (*field)
+*/
+void FinishFlowField(FlowField *field) {
+    if (!field->building) return;
+    WaitForJob(&field->job);
+    uint8_t *swap = field->directions;
+    field->directions = field->nextDirections;
+    field->nextDirections = swap;
+    field->target = field->nextTarget;
+    field->ready = true;
+    field->building = false;
+}
+
+/*
+Keeps the field pointed at a target: starts a rebuild (a job) when the target changes, and switches to it once it's done.
+Cheap to call every frame, the search only runs when the target changes (e.g. on pickup)
+Parameters: Pointer to the field (*field), pointer to map's data (*map) and the target (target)
+*/
+void UpdateFlowField(FlowField *field, const MapData *map, Vector2 target) {
+    if (field->building && IsJobDone(&field->job)) FinishFlowField(field);
+
+    bool current = field->ready && field->target.x == target.x && field->target.y == target.y;
+    bool coming = field->building && field->nextTarget.x == target.x && field->nextTarget.y == target.y;
+    if (current || coming) return;
+
+    FinishFlowField(field); // A rebuild for an older target, rare
+    field->ready = false;
+    field->map = map;
+    field->nextTarget = target;
+    field->building = true;
+    InitJob(&field->job, "flow field", buildFlowField, field);
+    SubmitJob(&field->job);
+}
+
+/*
+Reads the field at a position: one lookup
+Parameters: Pointer to the field (*field) and the position (position)
+Returns: Direction to follow (FlowDirection), FLOW_NONE if the field isn't ready or there's no way from there
+*/
+FlowDirection GetFlowDirection(const FlowField *field, Vector2 position) {
+    if (!field->ready || position.x < 0 || position.y < 0) return FLOW_NONE;
+    int cx = (int)(position.x / FLOW_CELL_SIZE);
+    int cy = (int)(position.y / FLOW_CELL_SIZE);
+    if (cx >= field->columns || cy >= field->rows) return FLOW_NONE;
+    return getFlow(field->directions, (int32_t)cy * field->columns + cx);
+}
+
+/*
+Follows the field a few cells ahead of a position, to find where the way to the target goes next
+Parameters: Pointer to the field (*field), the position (position), cells to follow (steps) and the point to fill (*waypoint):
+the center of the last cell reached, or the target itself once the way heads straight for it
+Returns: true if the field leads somewhere from the position. Otherwise, false
+*/
+bool GetFlowWaypoint(const FlowField *field, Vector2 position, int steps, Vector2 *waypoint) {
+    FlowDirection direction = GetFlowDirection(field, position);
+    if (direction == FLOW_NONE) return false;
+
+    int32_t cell = findFlowCell(field, position);
+    for (int i = 0; i < steps && direction < FLOW_TARGET; i++) {
+        cell += STEP_Y[direction] * field->columns + STEP_X[direction];
+        direction = getFlow(field->directions, cell);
+    }
+    if (direction == FLOW_TARGET) *waypoint = field->target;
+    else *waypoint = (Vector2){ (cell % field->columns + 0.5f) * FLOW_CELL_SIZE, (cell / field->columns + 0.5f) * FLOW_CELL_SIZE };
+    return true;
+}
+
+/*
+Follows the field from a position to the target, as a polyline (e.g. the route on the minimap)
+Parameters: Pointer to the field (*field), the position (position), cells between points (stride),
+the points to fill (*points) and their capacity (maxPoints)
+Returns: Number of points written (int), 0 if the field doesn't lead anywhere from the position
+*/
+int GetFlowRoute(const FlowField *field, Vector2 position, int stride, Vector2 *points, int maxPoints) {
+    int count = 0;
+    Vector2 point = position;
+    while (count < maxPoints) {
+        points[count++] = point;
+        if (point.x == field->target.x && point.y == field->target.y) break;
+        if (!GetFlowWaypoint(field, point, stride, &point)) return (count > 1) ? count : 0;
+    }
+    return count;
+}
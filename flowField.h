@@ -0,0 +1,56 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+
+#ifndef FLOWFIELD_H
+#define FLOWFIELD_H
+
+#include <stdint.h>
+#include "raylib.h"
+#include "mapData.h"
+#include "jobs.h"
+
+#define FLOW_CELL_SIZE 4 // Pixels per cell of the field
+
+// What a cell of the field says: one of 8 directions to the next cell (clockwise from east),
+// head straight for the target, or no way to it
+typedef enum {
+    FLOW_EAST, FLOW_SOUTH_EAST, FLOW_SOUTH, FLOW_SOUTH_WEST, FLOW_WEST, FLOW_NORTH_WEST, FLOW_NORTH, FLOW_NORTH_EAST,
+    FLOW_TARGET = 8,
+    FLOW_NONE = 15
+} FlowDirection;
+
+// Directions from every road cell of the map to one target, from a reverse Dijkstra that runs once per target (a job).
+// Until a new target's field is ready, lookups report no way and callers head straight for the target
+typedef struct {
+    int columns;
+    int rows;
+    uint8_t *directions;     // 4 bits per cell (FlowDirection), two cells per byte, the even cell in the low bits
+    Vector2 target;          // Target of directions
+    bool ready;              // directions leads to target
+    Job job;                 // Rebuild in the background
+    bool building;
+    const MapData *map;      // Read by the job
+    Vector2 nextTarget;      // Written by the job
+    uint8_t *nextDirections;
+} FlowField;
+
+// functions
+FlowField LoadFlowField(int mapWidth, int mapHeight);
+void UnloadFlowField(FlowField *field);
+void UpdateFlowField(FlowField *field, const MapData *map, Vector2 target);
+void FinishFlowField(FlowField *field);
+FlowDirection GetFlowDirection(const FlowField *field, Vector2 position);
+bool GetFlowWaypoint(const FlowField *field, Vector2 position, int steps, Vector2 *waypoint);
+int GetFlowRoute(const FlowField *field, Vector2 position, int stride, Vector2 *points, int maxPoints);
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "raylib.h"
+#include "headless.h"
+#include "simulation.h"
+#include "assetLoader.h"
+#include "platform.h"
+#include "flowField.h"
+
+// --- BOT CONSTANTS ---
+const int BOT_LOOKAHEAD = 4;          // Cells of the route (FLOW_CELL_SIZE pixels each) the bot steers towards
+const int BOT_STUCK_TICKS = 30;       // Ticks without moving before the bot tries a detour
+const int BOT_MIN_DETOUR_TICKS = 60;  // Length of a detour, in ticks
+const int BOT_MAX_DETOUR_TICKS = 240;
+const float BOT_ARRIVAL_SLACK = 2.0f; // Close enough on an axis to stop pressing its keys
+
+// A scripted player: follows the roads to the order's target (the same flow field as the game's arrow)
+// and takes a random detour when a vehicle stops it
+typedef struct {
+    FlowField route;
+    Vector2 lastPos;
+    int stillTicks;
+    int detourTicks;
+    PlayerInput detour;
+} HeadlessBot;
+
+/*
+Decides the keys the bot holds during the next tick
+Parameters: Pointer to the bot (*bot), pointer to the simulation (*sim) and pointer to map's data (*map)
+Returns: Keys held (PlayerInput)
+*/
+static PlayerInput botInput(HeadlessBot *bot, const Simulation *sim, const MapData *map) {
+    Vector2 pos = { sim->bike.x, sim->bike.y };
+    if (pos.x == bot->lastPos.x && pos.y == bot->lastPos.y) bot->stillTicks++;
+    else bot->stillTicks = 0;
+    bot->lastPos = pos;
+
+    if (bot->detourTicks > 0) {
+        bot->detourTicks--;
+        return bot->detour;
+    }
+
+    if (bot->stillTicks >= BOT_STUCK_TICKS) {
+        int direction = GetRandomValue(0, 3);
+        bot->detour = (PlayerInput){ direction == 0, direction == 1, direction == 2, direction == 3 };
+        bot->detourTicks = GetRandomValue(BOT_MIN_DETOUR_TICKS, BOT_MAX_DETOUR_TICKS);
+        bot->stillTicks = 0;
+        return bot->detour;
+    }
+
+    // The search runs only when the target changes. Waiting for it keeps sessions the same whatever the number of threads
+    Vector2 target = sim->order.foodPickedUp ? sim->order.dropoffLocation : sim->order.pickupLocation;
+    UpdateFlowField(&bot->route, map, target);
+    FinishFlowField(&bot->route);
+
+    // Steer towards a point a little down the route. Straight at the target once the route says so
+    // (or if it can't tell, e.g. off the road)
+    Vector2 waypoint;
+    if (!GetFlowWaypoint(&bot->route, pos, BOT_LOOKAHEAD, &waypoint)) waypoint = target;
+    float dx = waypoint.x - pos.x;
+    float dy = waypoint.y - pos.y;
+    return (PlayerInput){ dy < -BOT_ARRIVAL_SLACK, dy > BOT_ARRIVAL_SLACK, dx < -BOT_ARRIVAL_SLACK, dx > BOT_ARRIVAL_SLACK };
+}
+
+/*
+Plays sessions of Gameplay with no window, audio or GPU, as fast as the CPU allows, and prints the speed and each session's results.
+The simulation is the same one the game runs (StepSimulation); only the menus and drawing are skipped
+Parameter: Run's settings (options)
+Returns: 0 on success, 1 if the map couldn't be loaded (int), the program's exit code
+*/
+int RunHeadless(HeadlessOptions options) {
+    double start = GetPreciseTime();
+    MapData map = LoadMapAssets();
+    if (map.width == 0 || restaurantCount == 0 || houseCount == 0) {
+        fprintf(stderr, "Could not load the map\n");
+        return 1;
+    }
+    printf("headless: map loaded in %.1f ms, %d vehicles, %d session(s) of %.0f s, %s player\n", (GetPreciseTime() - start) * 1e3,
+           options.vehicles, options.sessions, options.sessionLength, (options.player == HEADLESS_PLAYER_BOT) ? "bot" : "idle");
+
+    Vector2 startPos = { map.width / 2.0f, map.height / 2.0f };
+    VehicleStore vehicles = LoadVehicleStore(options.vehicles, map.width, map.height);
+    vehicleGenerator(&vehicles, options.vehicles, &map, startPos);
+
+    Simulation sim = { 0 };
+    HeadlessBot bot = { 0 };
+    bot.route = LoadFlowField(map.width, map.height);
+    uint64_t totalTicks = 0;
+    int totalDeliveries = 0;
+    float totalMoney = 0;
+    double totalTime = 0;
+
+    for (int session = 1; session <= options.sessions; session++) {
+        ResetSimulation(&sim, startPos, PLAYER_SIZE);
+        sim.globalTimer = options.sessionLength;
+        bot.lastPos = startPos;
+        bot.stillTicks = 0;
+        bot.detourTicks = 0;
+
+        double sessionStart = GetPreciseTime();
+        while (!sim.isOver) {
+            PlayerInput input = (options.player == HEADLESS_PLAYER_BOT) ? botInput(&bot, &sim, &map) : (PlayerInput){ 0 };
+            StepSimulation(&sim, input, &vehicles, &map);
+        }
+        double elapsed = GetPreciseTime() - sessionStart;
+
+        printf("session %d: %llu ticks in %.2f s (%.0f ticks/s, %.1fx real time), %d deliveries, $%.2f\n", session,
+               (unsigned long long)sim.ticks, elapsed, sim.ticks / elapsed, sim.ticks / elapsed / SIMULATION_RATE, sim.count, sim.totalMoney);
+        totalTicks += sim.ticks;
+        totalDeliveries += sim.count;
+        totalMoney += sim.totalMoney;
+        totalTime += elapsed;
+    }
+
+    printf("total: %llu ticks in %.2f s (%.0f ticks/s), %d deliveries, $%.2f\n", (unsigned long long)totalTicks, totalTime,
+           totalTicks / totalTime, totalDeliveries, totalMoney);
+
+    UnloadFlowField(&bot.route);
+    UnloadVehicleStore(&vehicles);
+    UnloadMapLocations();
+    UnloadMapData(&map);
+    return 0;
+}
@@ -0,0 +1,33 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include "raylib.h"
+
+// Who drives the bike when nobody is at the keyboard
+typedef enum { HEADLESS_PLAYER_IDLE, HEADLESS_PLAYER_BOT } HeadlessPlayer;
+
+// Settings of a run without window, audio or GPU (see RunHeadless)
+typedef struct {
+    int vehicles;        // Traffic density
+    int sessions;        // Sessions played back to back
+    float sessionLength; // Seconds of game time per session
+    HeadlessPlayer player;
+} HeadlessOptions;
+
+// functions
+int RunHeadless(HeadlessOptions options);
+
+#endif
@@ -13,13 +13,16 @@
 #include "raylib.h"
 #include "raymath.h"
 #include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include "helpers.h"
+#include "simulation.h"
 
 const int weightRatio[3] = {5, 3, 2}; // 0:Cars, 1:Trucks, 2:Policecars
     
 const Color defaultColors[5] = {LIGHTGRAY, DARKGRAY, BLUE, RED, ORANGE};
 
-const char* restaurantNames[MAX_RESTAURANTS] = {
+const char* restaurantNames[RESTAURANT_NAMES] = {
     "Pizzeria Antonio",
     "Papa Nick's Burger House",
     "Hoy Ming Sushi",
@@ -30,61 +33,240 @@ const char* restaurantNames[MAX_RESTAURANTS] = {
     "Big Patty Burgers"
 };
 
-Building restaurants[MAX_RESTAURANTS];
+Building *restaurants = NULL;
 int restaurantCount;
 
-Building houses[MAX_HOUSES];
+Building *houses = NULL;
 int houseCount;
 
+float *deliveryDistances = NULL; // Road distance from restaurant r to house h at [r * houseCount + h], -1 if unreachable
+
+typedef enum { BLOB_NONE, BLOB_RESTAURANT, BLOB_HOUSE } BlobClass;
+
+// Provisional label of the connected-component labeling, merged through union-find
+typedef struct {
+    int parent;
+    BlobClass type;
+    int pixels;
+    long long sumX, sumY;
+    int minX, minY, maxX, maxY;
+} Blob;
+
+/*
+Finds the label a provisional label has been merged into (with path halving)
+Parameters: Labels (*blobs) and provisional label (label)
+Returns: Root label (int)
+*/
+static int findBlob(Blob *blobs, int label) {
+    while (blobs[label].parent != label) {
+        blobs[label].parent = blobs[blobs[label].parent].parent;
+        label = blobs[label].parent;
+    }
+    return label;
+}
+
+/*
+Merges two provisional labels. The older label stays the root, so buildings keep the map's scan order
+Parameters: Labels (*blobs) and the two labels (a, b)
+*/
+static void unionBlobs(Blob *blobs, int a, int b) {
+    a = findBlob(blobs, a);
+    b = findBlob(blobs, b);
+    if (a < b) blobs[b].parent = a;
+    else if (b < a) blobs[a].parent = b;
+}
+
+/*
+Adds a building to a growing array
+Parameters: Pointer to the array (**array), pointers to its size (*count) and capacity (*capacity) and the merged label (blob)
+Returns: Pointer to the new building
+*/
+static Building *appendBuilding(Building **array, int *count, int *capacity, const Blob *blob) {
+    if (*count == *capacity) {
+        *capacity = (*capacity == 0) ? 16 : *capacity * 2;
+        *array = realloc(*array, *capacity * sizeof(Building));
+    }
+    Building *b = &(*array)[(*count)++];
+    b->pos = (Vector2){ (float)blob->sumX / blob->pixels, (float)blob->sumY / blob->pixels };
+    b->bounds = (Rectangle){ blob->minX, blob->minY, blob->maxX - blob->minX + 1, blob->maxY - blob->minY + 1 };
+    b->name[0] = '\0';
+    return b;
+}
+
  /* 
- Scans map's image pixel-to-pixel to find restaurants' (green pixels) and houses' (blue pixels) locations
- Parameter: Map's image (map)
+ Finds restaurants (green blobs) and houses (blue blobs) with a single pass connected-component labeling
+ (8-connectivity, union-find) over the map's classified pixels. Every building gets its exact centroid and bounding box
+ Parameter: Pointer to map's data (*map)
  */
-void InitMapLocations(Image map) {
-    restaurantCount = 0;
-    houseCount = 0;
-    
-    Color *pixels = LoadImageColors(map);
-    
-    for (int y = 0; y < map.height; y += 5) {
-        for (int x = 0; x < map.width; x += 5) {
-            Color c = GetImageColor(map, x, y);
-            
-            // Scan for restaurants (GREEN)
-            if (c.g > 200 && c.r < 100 && c.b < 100) {
-                bool exists = false;
-            
-                for (int i = 0; i < restaurantCount; i++) {
-                    if (Vector2Distance((Vector2){(float)x, (float)y}, restaurants[i].pos) < minDistance) {
-                        exists = true;
-                        break;
-                    }
-                }
-                if (!exists && restaurantCount < MAX_RESTAURANTS) {
-                    restaurants[restaurantCount].pos = (Vector2){(float)x, (float)y};
-                    strcpy(restaurants[restaurantCount].name, restaurantNames[restaurantCount]);
-                    restaurantCount++;
-                }
-            }   
-        
-            // Scan for houses (BLUE)
-            if (c.b > 200 && c.g < 30) {
-                bool exists = false;
-                for (int i = 0; i < houseCount; i++) {
-                    if (Vector2Distance((Vector2){(float)x, (float)y}, houses[i].pos) < minDistance) {
-                        exists = true;
-                        break;
-                    }
-                }
-                if (!exists && houseCount < MAX_HOUSES) {
-                    houses[houseCount].pos = (Vector2){(float)x, (float)y};
-                    houseCount++;
+void InitMapLocations(const MapData *map) {
+    UnloadMapLocations();
+
+    int w = map->width;
+
+    // Only the labels of the previous and current row are needed
+    int *prevRow = malloc(w * sizeof(int));
+    int *currRow = malloc(w * sizeof(int));
+    int blobCapacity = 256;
+    int blobCount = 1; // Label 0 means "no building"
+    Blob *blobs = malloc(blobCapacity * sizeof(Blob));
+
+    for (int x = 0; x < w; x++) prevRow[x] = 0;
+
+    for (int y = 0; y < map->height; y++) {
+        const uint64_t *restaurantRow = map->restaurantBits + (size_t)y * map->wordsPerRow;
+        const uint64_t *houseRow = map->houseBits + (size_t)y * map->wordsPerRow;
+
+        for (int x = 0; x < w; x++) {
+            uint64_t bit = 1ULL << (x & 63);
+            currRow[x] = 0;
+
+            // Most of the map is neither, skip whole words
+            if (bit == 1 && (restaurantRow[x >> 6] | houseRow[x >> 6]) == 0) {
+                int end = (x + 64 < w) ? x + 64 : w;
+                for (; x < end; x++) currRow[x] = 0;
+                x--;
+                continue;
+            }
+
+            BlobClass type = BLOB_NONE;
+            if (restaurantRow[x >> 6] & bit) type = BLOB_RESTAURANT;
+            else if (houseRow[x >> 6] & bit) type = BLOB_HOUSE;
+            if (type == BLOB_NONE) continue;
+
+            // Already labeled neighbours: W, NW, N, NE
+            int neighbours[4] = {
+                (x > 0) ? currRow[x - 1] : 0,
+                (x > 0) ? prevRow[x - 1] : 0,
+                prevRow[x],
+                (x < w - 1) ? prevRow[x + 1] : 0
+            };
+
+            int label = 0;
+            for (int i = 0; i < 4; i++) {
+                int n = neighbours[i];
+                if (n == 0 || blobs[n].type != type) continue;
+                if (label == 0) label = n;
+                else if (n != label) unionBlobs(blobs, label, n);
+            }
+
+            if (label == 0) {
+                if (blobCount == blobCapacity) {
+                    blobCapacity *= 2;
+                    blobs = realloc(blobs, blobCapacity * sizeof(Blob));
                 }
+                label = blobCount++;
+                blobs[label] = (Blob){ label, type, 0, 0, 0, x, y, x, y };
             }
+
+            Blob *b = &blobs[label];
+            b->pixels++;
+            b->sumX += x;
+            b->sumY += y;
+            if (x < b->minX) b->minX = x;
+            if (x > b->maxX) b->maxX = x;
+            if (y > b->maxY) b->maxY = y;
+            currRow[x] = label;
         }
+
+        int *temp = prevRow; prevRow = currRow; currRow = temp;
     }
-    
-    UnloadImageColors(pixels);
+
+    free(prevRow);
+    free(currRow);
+
+    // Merge the statistics of every provisional label into its root
+    for (int i = 1; i < blobCount; i++) {
+        int root = findBlob(blobs, i);
+        if (root == i) continue;
+
+        Blob *r = &blobs[root];
+        r->pixels += blobs[i].pixels;
+        r->sumX += blobs[i].sumX;
+        r->sumY += blobs[i].sumY;
+        if (blobs[i].minX < r->minX) r->minX = blobs[i].minX;
+        if (blobs[i].minY < r->minY) r->minY = blobs[i].minY;
+        if (blobs[i].maxX > r->maxX) r->maxX = blobs[i].maxX;
+        if (blobs[i].maxY > r->maxY) r->maxY = blobs[i].maxY;
+    }
+
+    int restaurantCapacity = 0;
+    int houseCapacity = 0;
+    for (int i = 1; i < blobCount; i++) {
+        if (blobs[i].parent != i) continue;
+
+        if (blobs[i].type == BLOB_RESTAURANT) {
+            Building *r = appendBuilding(&restaurants, &restaurantCount, &restaurantCapacity, &blobs[i]);
+            int index = restaurantCount - 1;
+            // Reuse the names on maps with more restaurants than names
+            if (index < RESTAURANT_NAMES) snprintf(r->name, sizeof(r->name), "%s", restaurantNames[index]);
+            else snprintf(r->name, sizeof(r->name), "%s #%d", restaurantNames[index % RESTAURANT_NAMES], index / RESTAURANT_NAMES + 1);
+        } else {
+            appendBuilding(&houses, &houseCount, &houseCapacity, &blobs[i]);
+        }
+    }
+
+    free(blobs);
+}
+
+/*
+Frees the restaurants and houses found by InitMapLocations
+*/
+void UnloadMapLocations(void) {
+    free(restaurants);
+    free(houses);
+    restaurants = NULL;
+    houses = NULL;
+    restaurantCount = 0;
+    houseCount = 0;
+    free(deliveryDistances);
+    deliveryDistances = NULL;
+}
+
+/*
+Measures the road distance from every restaurant to every house, once per map (the table is saved in the map cache)
+Parameter: Pointer to map's data (*map) with its road network
+*/
+void InitDeliveryDistances(const MapData *map) {
+    free(deliveryDistances);
+    deliveryDistances = NULL;
+    if (restaurantCount == 0 || houseCount == 0) return;
+
+    Vector2 *pickups = malloc(restaurantCount * sizeof(Vector2));
+    Vector2 *dropoffs = malloc(houseCount * sizeof(Vector2));
+    for (int r = 0; r < restaurantCount; r++) pickups[r] = restaurants[r].pos;
+    for (int h = 0; h < houseCount; h++) dropoffs[h] = houses[h].pos;
+
+    deliveryDistances = malloc((size_t)restaurantCount * houseCount * sizeof(float));
+    FindRoadDistanceTable(&map->router, pickups, restaurantCount, dropoffs, houseCount, deliveryDistances);
+
+    free(pickups);
+    free(dropoffs);
+}
+
+/*
+Sets up the places traffic heads for, every restaurant and house, with their distances from every road node (see BuildRoadTargets).
+Rebuilt at every load, like the router they need, so they aren't cached
+Parameter: Pointer to map's data (*map) with its road network and buildings
+*/
+void InitTrafficDestinations(MapData *map) {
+    UnloadRoadTargets(&map->destinations);
+    int count = restaurantCount + houseCount;
+    Vector2 *positions = malloc((count + 1) * sizeof(Vector2));
+    for (int r = 0; r < restaurantCount; r++) positions[r] = restaurants[r].pos;
+    for (int h = 0; h < houseCount; h++) positions[restaurantCount + h] = houses[h].pos;
+
+    map->destinations = BuildRoadTargets(&map->router, positions, count);
+    free(positions);
+}
+
+/*
+Finds how far a house is from a restaurant by road. Without a table (no road network), falls back to the straight line
+Parameters: Restaurant's index (restaurant) and house's index (house)
+Returns: Distance in pixels, -1 if no road leads there (float)
+*/
+float GetDeliveryDistance(int restaurant, int house) {
+    if (deliveryDistances == NULL) return Vector2Distance(restaurants[restaurant].pos, houses[house].pos);
+    return deliveryDistances[(size_t)restaurant * houseCount + house];
 }
 
 /* 
@@ -96,6 +278,7 @@ Order CreateNewOrder()  {
     
     // Get random restaurant
     int restaurantIndex = GetRandomValue(0, restaurantCount - 1);
+    newOrder.restaurantIndex = restaurantIndex;
     newOrder.pickupLocation = restaurants[restaurantIndex].pos;
         
     strcpy(newOrder.restaurantName, restaurants[restaurantIndex].name);
@@ -111,12 +294,13 @@ Order CreateNewOrder()  {
 /* 
 Checks order status (pickup/dropoff) and calculates reward/fine
 Parameters: Pointers to struct with order information (*currentOrder), to number of orders (*count), to total money earned (*totalMoney),
-to houses (*houses), to type of message (*message), to last reward (*lastReward), player's position (bikePos) and number of houses (houseCount)
+to houses (*houses), to type of message (*message), to last reward (*lastReward), player's position (bikePos), number of houses (houseCount)
+and time since the last update, in seconds (dt)
 */
-void updateOrder(Order *currentOrder, Vector2 bikePos, int *count, float *totalMoney, Building *houses, int houseCount, OrderStatusMessage *message, float *lastReward)   {
+void updateOrder(Order *currentOrder, Vector2 bikePos, float dt, int *count, float *totalMoney, Building *houses, int houseCount, OrderStatusMessage *message, float *lastReward)   {
     if (currentOrder->isActive && currentOrder->foodPickedUp) {
         if (currentOrder->timeRemaining > 0) {
-            currentOrder->timeRemaining -= GetFrameTime();
+            currentOrder->timeRemaining -= dt;
             float distToHouse = Vector2Distance(bikePos, currentOrder->dropoffLocation);
             
             if (distToHouse < 7.5f)    {
@@ -156,9 +340,15 @@ void updateOrder(Order *currentOrder, Vector2 bikePos, int *count, float *totalM
             currentOrder->foodPickedUp = true;
         
             int randomHouse = GetRandomValue(0, houseCount - 1);
+            // Houses that no road leads to would make the order unwinnable, take the next one
+            for (int tries = 1; tries < houseCount && GetDeliveryDistance(currentOrder->restaurantIndex, randomHouse) < 0; tries++) {
+                randomHouse = (randomHouse + 1) % houseCount;
+            }
             currentOrder->dropoffLocation = houses[randomHouse].pos;
             
-            float distToHouse = Vector2Distance(currentOrder->pickupLocation, currentOrder->dropoffLocation);
+            // Reward and time go by the road's length, not the straight line that ignores the walls
+            float distToHouse = GetDeliveryDistance(currentOrder->restaurantIndex, randomHouse);
+            if (distToHouse < 0) distToHouse = Vector2Distance(currentOrder->pickupLocation, currentOrder->dropoffLocation);
             
             currentOrder->initialReward = 5.0f + (distToHouse * 0.02f);
             currentOrder->maxTimeAllowed = (distToHouse / 100.0f) * difficultyFactor + 11.0f;     
@@ -316,18 +506,15 @@ Color selectColor (TYPE_OF_VEHICLE selectedVehicle) {   // Select random color
 
 /*
 Checks if a vehicle is out of road limits
-Parameters: Image of map's limits (image) and vehicle's position (point)
+Parameters: Pointer to map's data (*map) and vehicle's position (point)
 Returns: true if out of limits. Otherwise, false
 */ 
-bool willTouchBorder(Image image, Vector2 point) {
-    // Safety check to prevent crashing if coordinates are off-map
-    if (point.x < 0 || point.y < 0 || point.x >= image.width || point.y >= image.height) return true;
+bool willTouchBorder(const MapData *map, Vector2 point) {
+    // Negative coordinates must not be truncated towards pixel 0
+    if (point.x < 0 || point.y < 0) return true;
 
-    Color c = GetImageColor(image, (int)point.x, (int)point.y);
-    
-    // If the pixel is "Too Red" 
-    if (c.r > 150 && c.g < 100 && c.b < 100) return true;
-    return false;
+    // Off-map pixels count as walls
+    return IsWallPixel(map, (int)point.x, (int)point.y);
 }
 
 /* 
@@ -347,173 +534,98 @@ void getVehicleSize(TYPE_OF_VEHICLE type, float *w, float *h) {
 
 /* 
 Checks if a vehicle's position is valid
-Parameters: Image of map with borders (image), vehicle's coordinates (px, py), type of vehicle (type) and vehicle's rotation (rotation)
+Parameters: Pointer to map's data (*map), vehicle's coordinates (px, py), type of vehicle (type) and vehicle's rotation (rotation)
 Returns: true if position is valid. Otherwise, false
 */
-bool isVehiclePositionValid(Image image, float px, float py, TYPE_OF_VEHICLE type, int rotation) {
-    // Scaled dimensions for collision check
-    float w = (type == TRUCK) ? 11.0f : 8.0f;
-    float h = (type == TRUCK) ? 22.0f : 13.0f;
-
-    // Swap box dimensions if horizontal
-    if (rotation == 90 || rotation == 270) {
-        float temp = w; w = h; h = temp;
-    }
-
-    Vector2 corners[4] = {
-        { px - w/2, py - h/2 }, { px + w/2, py - h/2 },
-        { px - w/2, py + h/2 }, { px + w/2, py + h/2 }
-    };
-
-    // check center
-    if (willTouchBorder(image, (Vector2){px, py})) return false;
-
-    for (int i = 0; i < 4; i++) {
-        if (willTouchBorder(image, corners[i])) return false;
-    }
-    return true;
+bool isVehiclePositionValid(const MapData *map, float px, float py, TYPE_OF_VEHICLE type, int rotation) {
+    // Every footprint has a precomputed mask of valid centers
+    return IsPoseValid(map, getVehiclePose(type, rotation), px, py);
 }
 
 /* 
 Draws vehicle's sprite at correct size and locations
-Parameters: vehicle's struct (v), car's sprite (carT), truck's sprite (truckT) and policecar's sprite (policeT)
+Parameters: Pointer to the vehicle store (*store), vehicle's index (i), fraction of a tick since the last update (alpha),
+car's sprite (carT), truck's sprite (truckT) and policecar's sprite (policeT)
 */
-void RenderVehicle(Vehicle v, RenderTexture2D carT, RenderTexture2D truckT, RenderTexture2D policeT) {
+void RenderVehicle(const VehicleStore *store, int i, float alpha, RenderTexture2D carT, RenderTexture2D truckT, RenderTexture2D policeT) {
     Texture2D tex;
     Rectangle source;
     float w, h;
+    TYPE_OF_VEHICLE type = (TYPE_OF_VEHICLE)store->type[i];
 
-    if (v.type == TRUCK) {
+    if (type == TRUCK) {
         tex = truckT.texture;
         source = (Rectangle){ 0, 0, 65, 110 }; 
         w = 13.0f; h = 22.0f; 
     } else {
-        tex = (v.type == POLICE) ? policeT.texture : carT.texture;
+        tex = (type == POLICE) ? policeT.texture : carT.texture;
         source = (Rectangle){ 0, 0, 40, 65 };
         w = 8.0f; h = 13.0f;
     }
 
-    Rectangle dest = { v.posx, v.posy, w, h };
+    Vector2 pos = GetVehicleRenderPosition(store, i, alpha);
+    Rectangle dest = { pos.x, pos.y, w, h };
     Vector2 origin = { w / 2, h / 2 };
 
-    DrawTexturePro(tex, source, dest, origin, (float)v.rotation, v.vehicleColor);
+    DrawTexturePro(tex, source, dest, origin, GetVehicleRotation(store, i), store->color[i]);
+}
+
+/*
+Checks if any vehicle is centered within a distance of a point
+Parameters: Pointer to the vehicle store (*store), point (pos) and distance (radius)
+Returns: true if there is one. Otherwise, false
+*/
+bool isVehicleNearby(const VehicleStore *store, Vector2 pos, float radius) {
+    VehicleQuery query = BeginVehicleQuery(store, (Rectangle){ pos.x - radius, pos.y - radius, 2 * radius, 2 * radius });
+    for (int i = NextVehicle(store, &query); i >= 0; i = NextVehicle(store, &query)) {
+        if (Vector2Distance(pos, (Vector2){store->x[i], store->y[i]}) < radius) return true;
+    }
+    return false;
 }
 
 /* 
-Generates vehicles at random valid positions
-Parameters: Number of vehicles (numOfVehicles), vehicles' array (vehicles[]), map's dimensions (mapHeight, mapWidth),
-image of map with borders (mapWithBorders) and player's starting position (playerStartPos)
+Generates vehicles at random valid positions, drawn straight from the valid centers of their footprint
+Parameters: Pointer to the vehicle store (*store), number of vehicles to add (numOfVehicles),
+pointer to map's data (*map) and player's starting position (playerStartPos)
 */
-void vehicleGenerator(int numOfVehicles, Vehicle vehicles[], int mapHeight, int mapWidth, Image mapWithBorders, Vector2 playerStartPos) {
+void vehicleGenerator(VehicleStore *store, int numOfVehicles, const MapData *map, Vector2 playerStartPos) {
     for (int i = 0; i < numOfVehicles; i++) {
         TYPE_OF_VEHICLE type = mapRandomToVehicleType(GetRandomValue(0, 10));
-        bool found = false;
-        float rx, ry;
-        int rotation;
-
-        int attempts = 0;
-        
-        while (!found && attempts < 1000) { // Safety break to prevent infinite loops
-            rx = (float)GetRandomValue(100, mapWidth - 100);
-            ry = (float)GetRandomValue(100, mapHeight - 100);
-            rotation = GetRandomValue(0, 3) * 90;
-
-            // Check distance to player (Safe Zone of 250 pixels)
-            float distToPlayer = Vector2Distance((Vector2){rx, ry}, playerStartPos);
-
-            if (distToPlayer > 250.0f && isVehiclePositionValid(mapWithBorders, rx, ry, type, rotation)) {
-                found = true;
-            }
-            attempts++;
+        int rotation = GetRandomValue(0, 3) * 90;
+        Vector2 pos = { map->width / 2.0f, map->height / 2.0f }; // Fallback, if this footprint fits nowhere
+
+        // Every draw is on the road, we only draw again inside the player's safe zone or on top of another vehicle.
+        // In dense traffic every spot may be taken, then the last draw is kept
+        for (int attempt = 0; attempt < SPAWN_ATTEMPTS; attempt++) {
+            if (!GetRandomPosePosition(map, getVehiclePose(type, rotation), &pos)) break;
+            if (Vector2Distance(pos, playerStartPos) > SPAWN_SAFE_DISTANCE && !isVehicleNearby(store, pos, SPAWN_CLEARANCE)) break;
         }
 
-        vehicles[i].type = type;
-        vehicles[i].posx = rx;
-        vehicles[i].posy = ry;
-        vehicles[i].vehicleColor = selectColor(type);
-        vehicles[i].speed = (float)GetRandomValue(8, 16) / 10.0f;
-        vehicles[i].rotation = rotation;
+        float speed = (float)GetRandomValue(VEHICLE_MIN_SPEED, VEHICLE_MAX_SPEED) / SIMULATION_RATE; // Per tick
+        AddVehicle(store, type, pos, rotation, speed, selectColor(type));
     }
 }
 
 /*
-Controls vehicles' movement
-Parameters: Pointer to vehicle's struct (*vehicles), maximum number of vehicles (maxVehicles),
-image of map with borders (mapWithBorders) and player's position (playerPos)
+Changes the number of vehicles on the map: new ones spawn away from the player, extra ones are removed (newest first)
+Parameters: Pointer to the vehicle store (*store), wanted number of vehicles (numOfVehicles),
+pointer to map's data (*map) and player's position (playerPos)
 */
-void updateTraffic(Vehicle *vehicles, int maxVehicles, Image mapWithBorders, Vector2 playerPos) {
-    for (int i = 0; i < maxVehicles; i++) {
-        
-        // Collision with player logic (Stop if close)
-        float dx = vehicles[i].posx - playerPos.x;
-        float dy = vehicles[i].posy - playerPos.y;
-        if ((dx*dx + dy*dy) < (STOPPING_DISTANCE * STOPPING_DISTANCE)) {
-            continue; 
-        }
-
-        float oldX = vehicles[i].posx;
-        float oldY = vehicles[i].posy;
-
-        // Apply movement
-        if (vehicles[i].rotation == 0)        vehicles[i].posy += vehicles[i].speed;
-        else if (vehicles[i].rotation == 180) vehicles[i].posy -= vehicles[i].speed;
-        else if (vehicles[i].rotation == 90)  vehicles[i].posx -= vehicles[i].speed;
-        else if (vehicles[i].rotation == 270) vehicles[i].posx += vehicles[i].speed;
-
-        // If the new move is invalid (hit a wall)
-        if (!isVehiclePositionValid(mapWithBorders, vehicles[i].posx, vehicles[i].posy, vehicles[i].type, vehicles[i].rotation)) {
-            
-            // 1. Reset position immediately so they don't clip into the wall
-            vehicles[i].posx = oldX;
-            vehicles[i].posy = oldY;
-
-            // 2. Try to find a valid direction instead of purely random
-            // Current rotation
-            int currentRot = vehicles[i].rotation;
-            
-            // Define relative turns: [Left, Right, Back]
-            // We favor turning 90 degrees over going fully backwards
-            int candidates[3];
-            candidates[0] = (currentRot + 90) % 360;  // Turn Right
-            candidates[1] = (currentRot + 270) % 360; // Turn Left
-            candidates[2] = (currentRot + 180) % 360; // Reverse
-
-            bool directionFound = false;
-
-            // Check which of these directions is free
-            for (int d = 0; d < 3; d++) {
-                int testRot = candidates[d];
-                float testX = oldX;
-                float testY = oldY;
-                float lookAhead = 10.0f; // Look a bit ahead to see if it's clear
-
-                if (testRot == 0) testY += lookAhead;
-                else if (testRot == 180) testY -= lookAhead;
-                else if (testRot == 90) testX -= lookAhead;
-                else if (testRot == 270) testX += lookAhead;
-
-                if (isVehiclePositionValid(mapWithBorders, testX, testY, vehicles[i].type, testRot)) {
-                    vehicles[i].rotation = testRot;
-                    directionFound = true;
-                    break; // Stop looking, we found a path
-                }
-            }
-
-            // If completely stuck (boxed in), pick a random one as a last resort
-            if (!directionFound) {
-                 vehicles[i].rotation = candidates[GetRandomValue(0, 2)];
-            }
-        }
+void setTrafficDensity(VehicleStore *store, int numOfVehicles, const MapData *map, Vector2 playerPos) {
+    if (numOfVehicles > store->count) {
+        vehicleGenerator(store, numOfVehicles - store->count, map, playerPos);
+    }
+    while (store->count > numOfVehicles) {
+        RemoveVehicle(store, GetVehicleHandle(store, store->count - 1));
     }
 }
 
 /*
 Checks if vehicles collide
-Parameters: Player's hitbox (playerRect), pointer to vehicle's struct (*vehicles), 
-maximum number of vehicles (maxVehicles) and use of margin (useMargin)
+Parameters: Player's hitbox (playerRect), pointer to the vehicle store (*store) and use of margin (useMargin)
 Returns: true in case of collision. Otherwise, false
 */
-bool checkCollisionWithVehicles(Rectangle playerRect, Vehicle *vehicles, int maxVehicles, bool useMargin) {
+bool checkCollisionWithVehicles(Rectangle playerRect, const VehicleStore *store, bool useMargin) {
     
     Rectangle playerBox = {
         playerRect.x - playerRect.width/2,
@@ -532,17 +644,21 @@ bool checkCollisionWithVehicles(Rectangle playerRect, Vehicle *vehicles, int max
         playerBox.height -= (margin * 2);
     }
 
-    for (int i = 0; i < maxVehicles; i++) {
+    // Only vehicles centered close enough to reach the box can touch it
+    Rectangle reach = { playerBox.x - VEHICLE_MAX_HALF_LENGTH, playerBox.y - VEHICLE_MAX_HALF_LENGTH,
+                        playerBox.width + 2 * VEHICLE_MAX_HALF_LENGTH, playerBox.height + 2 * VEHICLE_MAX_HALF_LENGTH };
+    VehicleQuery query = BeginVehicleQuery(store, reach);
+    for (int i = NextVehicle(store, &query); i >= 0; i = NextVehicle(store, &query)) {
         float w, h;
-        getVehicleSize(vehicles[i].type, &w, &h);
+        getVehicleSize((TYPE_OF_VEHICLE)store->type[i], &w, &h);
 
-        if (vehicles[i].rotation == 90 || vehicles[i].rotation == 270) {
+        if (store->dirX[i] != 0) { // Heading left or right
             float temp = w; w = h; h = temp;
         }
 
         Rectangle npcBox = {
-            vehicles[i].posx - w/2,
-            vehicles[i].posy - h/2,
+            store->x[i] - w/2,
+            store->y[i] - h/2,
             w,
             h
         };
@@ -556,35 +672,20 @@ bool checkCollisionWithVehicles(Rectangle playerRect, Vehicle *vehicles, int max
 
 /*
 Respawns player at a random valid position
-Parameters: Map's image (map), pointer vehicle's struct, 
-number of maximum vehicles (maxVehicles) and map's dimensions (mapWidth, mapHeight)
+Parameters: Pointer to map's data (*map) and pointer to the vehicle store (*store)
 Returns: Valid position (Vector2)
 */
-Vector2 GetRandomValidPosition(Image map, Vehicle *vehicles, int maxVehicles, int mapWidth, int mapHeight) {
-    int attempts = 0;
-    while (attempts < 1000) {
-        float rx = (float)GetRandomValue(100, mapWidth - 100);
-        float ry = (float)GetRandomValue(100, mapHeight - 100);
-        
-        // 1. Check if inside border
-        if (willTouchBorder(map, (Vector2){rx, ry})) {
-            attempts++;
-            continue;
-        }
-        
-        // 2. Check if overlapping with any existing vehicle
-        bool hitVehicle = false;
-        for(int i=0; i<maxVehicles; i++) {
-            if (Vector2Distance((Vector2){rx, ry}, (Vector2){vehicles[i].posx, vehicles[i].posy}) < 50.0f) {
-                hitVehicle = true;
-                break;
-            }
-        }
-        
-        if (!hitVehicle) return (Vector2){rx, ry};
-        
-        attempts++;
+Vector2 GetRandomValidPosition(const MapData *map, const VehicleStore *store) {
+    Vector2 pos = { map->width / 2.0f, map->height / 2.0f }; // Fallback, if the bike fits nowhere
+
+    // In dense traffic every spot may be taken, then the last draw is kept: on the road, even if next to a vehicle
+    for (int attempt = 0; attempt < SPAWN_ATTEMPTS; attempt++) {
+        // The bike fits wherever a car does
+        if (!GetRandomPosePosition(map, POSE_CAR_VERTICAL, &pos)) break;
+
+        // Check if overlapping with any existing vehicle
+        if (!isVehicleNearby(store, pos, RESPAWN_CLEARANCE)) break;
     }
-    
-    return (Vector2){ (float)mapWidth/2, (float)mapHeight/2 }; // Fallback
+
+    return pos;
 }
\ No newline at end of file
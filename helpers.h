@@ -14,17 +14,23 @@
 #define HELPERS_H
 
 #include"raylib.h"
+#include "mapData.h"
+#include "vehicles.h"
 
 // constants
-#define MAX_VEHICLES 20
-#define MAX_RESTAURANTS  8
-#define MAX_HOUSES 20
-#define minDistance 30 // Distance for colored pixels to be considered as one building
-#define STOPPING_DISTANCE 20.0f
+#define DEFAULT_VEHICLES 20
+#define MAX_VEHICLES 1000000 // Upper bound for --vehicles and the options
+#define RESTAURANT_NAMES 8
 #define DISPLAY_MESSAGE_TIME 2.0f
+#define SPAWN_ATTEMPTS 16 // Spawn positions are always on the road, retries only avoid the player and other vehicles
+#define SPAWN_SAFE_DISTANCE 250.0f
+#define SPAWN_CLEARANCE 22.0f // Distance between a new vehicle's center and any other (a truck's length)
+#define RESPAWN_CLEARANCE 50.0f // Same, for the player's respawn
+#define VEHICLE_MIN_SPEED 48 // Pixels per second
+#define VEHICLE_MAX_SPEED 96
 extern const int weightRatio[3]; 
 extern const Color defaultColors[5];
-extern const char* restaurantNames[MAX_RESTAURANTS];
+extern const char* restaurantNames[RESTAURANT_NAMES];
 
 // integers
 extern int restaurantCount;
@@ -35,7 +41,6 @@ extern float difficultyFactor;
 // type defs
 typedef enum { STATE_MENU, STATE_GAMEPLAY, STATE_OPTIONS, STATE_GAME_OVER, STATE_CONTROLS, STATE_ABOUT_CREATORS, STATE_GAMEOVER } GameState;
 typedef enum { PENDING, SUCCESS, FAILURE } TypeOfMessage;
-typedef enum { CAR, TRUCK, POLICE } TYPE_OF_VEHICLE;
 
 typedef struct {
     float timer;
@@ -43,16 +48,20 @@ typedef struct {
 } OrderStatusMessage;
 
 typedef struct  {
-    Vector2 pos;
+    Vector2 pos; // Centroid of the building's pixels
+    Rectangle bounds;
     char name[50];
 } Building;
 
-extern Building houses[MAX_HOUSES];
+extern Building *restaurants;
+extern Building *houses;
+extern float *deliveryDistances;
 
 typedef struct {
     Vector2 pickupLocation;
     Vector2 dropoffLocation;
     char restaurantName[50];
+    int restaurantIndex;
     bool isActive;
     bool foodPickedUp;
     float initialReward;
@@ -60,32 +69,28 @@ typedef struct {
     float maxTimeAllowed;
 } Order;
 
-typedef struct {
-    TYPE_OF_VEHICLE type;
-    Color vehicleColor;
-    float posx;
-    float posy;
-    float speed;
-    int rotation; 
-} Vehicle;
-
 // functions
-void InitMapLocations (Image map);
+void InitMapLocations (const MapData *map);
+void UnloadMapLocations(void);
+void InitDeliveryDistances(const MapData *map);
+void InitTrafficDestinations(MapData *map);
+float GetDeliveryDistance(int restaurant, int house);
 Order CreateNewOrder();
-void updateOrder(Order *currentOrder, Vector2 bikePos, int *count, float *totalMoney, Building *houses, int houseCount, OrderStatusMessage *message, float *lastReward);
+void updateOrder(Order *currentOrder, Vector2 bikePos, float dt, int *count, float *totalMoney, Building *houses, int houseCount, OrderStatusMessage *message, float *lastReward);
 void displayOrderMessage(OrderStatusMessage *message, float lastReward);
 bool DrawButton(const char *text, Rectangle rec, int fontSize, Color color, Color hoverColor, Color textColor);
 void DrawControlKey(const char* key, const char* action, int x, int y);
 TYPE_OF_VEHICLE mapRandomToVehicleType(int random);
 Color selectColor (TYPE_OF_VEHICLE selectedVehicle);
-bool willTouchBorder(Image image, Vector2 point);
+bool willTouchBorder(const MapData *map, Vector2 point);
 void getVehicleSize(TYPE_OF_VEHICLE type, float *w, float *h);
-bool isVehiclePositionValid(Image image, float px, float py, TYPE_OF_VEHICLE type, int rotation);
-void RenderVehicle(Vehicle v, RenderTexture2D carT, RenderTexture2D truckT, RenderTexture2D policeT);
-void vehicleGenerator(int numOfVehicles, Vehicle vehicles[], int mapHeight, int mapWidth, Image mapWithBorders, Vector2 playerStartPos);
-void updateTraffic(Vehicle *vehicles, int maxVehicles, Image mapWithBorders, Vector2 playerPos);
-bool checkCollisionWithVehicles(Rectangle playerRect, Vehicle *vehicles, int maxVehicles, bool useMargin);
-Vector2 GetRandomValidPosition(Image map, Vehicle *vehicles, int maxVehicles, int mapWidth, int mapHeight);
+bool isVehiclePositionValid(const MapData *map, float px, float py, TYPE_OF_VEHICLE type, int rotation);
+void RenderVehicle(const VehicleStore *store, int i, float alpha, RenderTexture2D carT, RenderTexture2D truckT, RenderTexture2D policeT);
+void vehicleGenerator(VehicleStore *store, int numOfVehicles, const MapData *map, Vector2 playerStartPos);
+void setTrafficDensity(VehicleStore *store, int numOfVehicles, const MapData *map, Vector2 playerPos);
+bool isVehicleNearby(const VehicleStore *store, Vector2 pos, float radius);
+bool checkCollisionWithVehicles(Rectangle playerRect, const VehicleStore *store, bool useMargin);
+Vector2 GetRandomValidPosition(const MapData *map, const VehicleStore *store);
 
 
 #endif
\ No newline at end of file
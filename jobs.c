@@ -0,0 +1,338 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+#include <stdint.h>
+#include <pthread.h>
+#include "jobs.h"
+#include "platform.h"
+
+#define JOB_DEQUE_CAPACITY 1024 // Power of 2
+
+// Work-stealing deque (Chase-Lev). Its owner pushes and pops jobs at the bottom (newest first, while they are still in cache),
+// every other thread steals from the top (oldest first). Only stealing and taking the last job need a compare-and-swap
+typedef struct {
+    atomic_long top;
+    atomic_long bottom;
+    _Atomic(Job *) jobs[JOB_DEQUE_CAPACITY];
+} JobDeque;
+
+// One deque per thread: 0 belongs to the main thread, 1..workerCount to the workers
+static JobDeque deques[MAX_JOB_WORKERS + 1];
+
+// Idle threads sleep on a condition variable. Jobs are pushed without the lock, so a thread counts itself as sleeping
+// before it checks the deques one last time, and whoever pushes or finishes a job only takes the lock if someone sleeps
+static pthread_mutex_t sleepLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t workChanged = PTHREAD_COND_INITIALIZER; // A job was pushed or finished
+static atomic_int sleepers = 0;
+
+// Guards every job's list of dependents
+static pthread_mutex_t dependencyLock = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_t workers[MAX_JOB_WORKERS];
+static atomic_int workerCount = 0; // Read by every thread that looks for work
+static atomic_bool running = false;
+static _Thread_local int currentWorker = 0; // 0 on the main thread, 1..workerCount on workers
+static _Thread_local uint32_t stealSeed = 0; // Picks where to start looking for victims
+static _Atomic(JobObserver) jobObserver = NULL;
+
+/*
+Adds a job at the bottom of the calling thread's deque. Only the deque's owner may call it
+Parameters: Pointer to the deque (*deque) and to the job (*job)
+Returns: true if added. Otherwise (deque full), false
+*/
+static bool pushJob(JobDeque *deque, Job *job) {
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    if (bottom - top >= JOB_DEQUE_CAPACITY) return false;
+
+    atomic_store_explicit(&deque->jobs[bottom & (JOB_DEQUE_CAPACITY - 1)], job, memory_order_relaxed);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_release); // Publishes the job to thieves
+    return true;
+}
+
+/*
+Takes the newest job from the bottom of the calling thread's deque. Only the deque's owner may call it
+Parameter: Pointer to the deque (*deque)
+Returns: Pointer to the job (NULL if the deque is empty)
+*/
+static Job *popJob(JobDeque *deque) {
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (top > bottom) { // Empty
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    Job *job = atomic_load_explicit(&deque->jobs[bottom & (JOB_DEQUE_CAPACITY - 1)], memory_order_relaxed);
+    if (top == bottom) {
+        // Last job: a thief may be taking it right now, whoever moves top first gets it
+        if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed)) job = NULL;
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+    return job;
+}
+
+/*
+Takes the oldest job from the top of another thread's deque
+Parameter: Pointer to the deque (*deque)
+Returns: Pointer to the job (NULL if the deque is empty or another thread took the job first)
+*/
+static Job *stealJob(JobDeque *deque) {
+    long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (top >= bottom) return NULL;
+
+    Job *job = atomic_load_explicit(&deque->jobs[top & (JOB_DEQUE_CAPACITY - 1)], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed)) return NULL;
+    return job;
+}
+
+/*
+Finds a job for the calling thread: its own newest one, else the oldest one of another thread
+Returns: Pointer to the job (NULL if there is no work anywhere)
+*/
+static Job *findJob(void) {
+    Job *job = popJob(&deques[currentWorker]);
+    if (job != NULL) return job;
+
+    // Start from a different victim every time, so that thieves spread out
+    int threads = workerCount + 1;
+    stealSeed = stealSeed * 1664525u + 1013904223u;
+    int first = (int)((stealSeed >> 16) % (uint32_t)threads);
+    for (int k = 0; k < threads; k++) {
+        int victim = (first + k) % threads;
+        if (victim == currentWorker) continue;
+        job = stealJob(&deques[victim]);
+        if (job != NULL) return job;
+    }
+    return NULL;
+}
+
+/*
+Checks, without taking anything, if any deque has jobs
+Returns: true if there is work. Otherwise, false
+*/
+static bool hasWork(void) {
+    for (int t = 0; t <= workerCount; t++) {
+        if (atomic_load(&deques[t].top) < atomic_load(&deques[t].bottom)) return true;
+    }
+    return false;
+}
+
+/*
+Wakes the sleeping threads, if there are any
+*/
+static void wakeSleepers(void) {
+    atomic_thread_fence(memory_order_seq_cst); // Pairs with the sleeper's count, see above
+    if (atomic_load(&sleepers) == 0) return;
+    pthread_mutex_lock(&sleepLock);
+    pthread_cond_broadcast(&workChanged);
+    pthread_mutex_unlock(&sleepLock);
+}
+
+/*
+Puts the calling thread to sleep until a job is pushed or finished, unless there is work already or it should stop
+Parameter: Job the thread waits for, NULL for workers (*waitingFor)
+*/
+static void sleepUntilWork(Job *waitingFor) {
+    pthread_mutex_lock(&sleepLock);
+    atomic_fetch_add(&sleepers, 1);
+    bool stillIdle = (waitingFor != NULL) ? !atomic_load(&waitingFor->done) : atomic_load(&running);
+    if (stillIdle && !hasWork()) pthread_cond_wait(&workChanged, &sleepLock);
+    atomic_fetch_sub(&sleepers, 1);
+    pthread_mutex_unlock(&sleepLock);
+}
+
+/*
+Runs a job on the calling thread and releases the jobs that were waiting for it
+Parameter: Pointer to the job (*job)
+*/
+static void runJob(Job *job);
+
+/*
+Hands a job whose dependencies are done to the workers, through the calling thread's deque. Runs it right away if the deque is full
+Parameter: Pointer to the job (*job)
+*/
+static void enqueueJob(Job *job) {
+    if (!pushJob(&deques[currentWorker], job)) {
+        runJob(job);
+        return;
+    }
+    wakeSleepers();
+}
+
+static void runJob(Job *job) {
+    job->worker = currentWorker;
+    job->startTime = GetPreciseTime();
+    job->function(job->data);
+    job->endTime = GetPreciseTime();
+    JobObserver observer = atomic_load(&jobObserver);
+    if (observer != NULL) observer(job);
+
+    // Once done is set no more dependents can be added, and the job's owner may reuse it, so the list is copied first
+    Job *dependents[MAX_JOB_DEPENDENTS];
+    pthread_mutex_lock(&dependencyLock);
+    int dependentCount = job->dependentCount;
+    for (int i = 0; i < dependentCount; i++) dependents[i] = job->dependents[i];
+    atomic_store(&job->done, true);
+    pthread_mutex_unlock(&dependencyLock);
+    wakeSleepers();
+
+    for (int i = 0; i < dependentCount; i++) {
+        if (atomic_fetch_sub(&dependents[i]->pending, 1) == 1) enqueueJob(dependents[i]);
+    }
+}
+
+/*
+Worker thread's loop: runs its own and stolen jobs until the job system shuts down
+Parameter: Worker's index, starting from 1 (arg)
+*/
+static void *workerMain(void *arg) {
+    currentWorker = (int)(intptr_t)arg;
+    stealSeed = (uint32_t)currentWorker;
+
+    while (atomic_load(&running)) {
+        Job *job = findJob();
+        if (job != NULL) runJob(job);
+        else sleepUntilWork(NULL);
+    }
+    return NULL;
+}
+
+/*
+Starts the worker threads. Without workers, jobs run on the thread that waits for them
+Parameter: Number of threads that run jobs, counting the main thread (threadCount).
+0 or less for one per CPU core, but at least one worker so that loading overlaps with opening the window
+*/
+void InitJobSystem(int threadCount) {
+    if (atomic_load(&running)) return;
+    int count = threadCount - 1;
+    if (threadCount <= 0) {
+        count = GetProcessorCount() - 1;
+        if (count < 1) count = 1;
+    }
+    if (count < 0) count = 0;
+    if (count > MAX_JOB_WORKERS) count = MAX_JOB_WORKERS;
+
+    for (int t = 0; t <= MAX_JOB_WORKERS; t++) {
+        atomic_init(&deques[t].top, 0);
+        atomic_init(&deques[t].bottom, 0);
+    }
+
+    atomic_store(&running, true);
+    int started = 0;
+    while (started < count && pthread_create(&workers[started], NULL, workerMain, (void *)(intptr_t)(started + 1)) == 0) {
+        started++;
+        atomic_store(&workerCount, started);
+    }
+}
+
+/*
+Stops and joins the worker threads. Jobs still in the deques are left unfinished
+*/
+void ShutdownJobSystem(void) {
+    pthread_mutex_lock(&sleepLock);
+    atomic_store(&running, false);
+    pthread_cond_broadcast(&workChanged);
+    pthread_mutex_unlock(&sleepLock);
+
+    for (int i = 0; i < workerCount; i++) pthread_join(workers[i], NULL);
+    workerCount = 0;
+}
+
+/*
+Finds how many worker threads are running
+Returns: Number of workers (int)
+*/
+int GetJobWorkerCount(void) {
+    return workerCount;
+}
+
+/*
+Prepares a job before adding dependencies to it and submitting it
+Parameters: Pointer to the job (*job), its name for logs (*name), function to run (function) and its argument (*data)
+*/
+void InitJob(Job *job, const char *name, JobFunction function, void *data) {
+    job->name = name;
+    job->function = function;
+    job->data = data;
+    atomic_init(&job->pending, 1);
+    atomic_init(&job->done, false);
+    job->dependentCount = 0;
+    job->worker = 0;
+    job->startTime = 0;
+    job->endTime = 0;
+}
+
+/*
+Makes a job wait for another one. Must be called before the job is submitted
+Parameters: Pointer to the waiting job (*job) and to the job it waits for (*dependency)
+*/
+void AddJobDependency(Job *job, Job *dependency) {
+    bool mustWait = false;
+
+    pthread_mutex_lock(&dependencyLock);
+    if (!atomic_load(&dependency->done)) {
+        if (dependency->dependentCount < MAX_JOB_DEPENDENTS) {
+            atomic_fetch_add(&job->pending, 1);
+            dependency->dependents[dependency->dependentCount++] = job;
+        } else {
+            mustWait = true;
+        }
+    }
+    pthread_mutex_unlock(&dependencyLock);
+
+    // No room left in the dependency's list, so it has to finish before we go on
+    if (mustWait) WaitForJob(dependency);
+}
+
+/*
+Hands a job to the workers. It runs as soon as all of its dependencies are done
+Parameter: Pointer to the job (*job)
+*/
+void SubmitJob(Job *job) {
+    if (atomic_fetch_sub(&job->pending, 1) == 1) enqueueJob(job);
+}
+
+/*
+Blocks until a job is done. Meanwhile, the calling thread runs (or steals) queued jobs too, so waiting
+from inside a job (or without any workers) can't deadlock
+Parameter: Pointer to the job (*job)
+*/
+void WaitForJob(Job *job) {
+    while (!atomic_load(&job->done)) {
+        Job *other = findJob();
+        if (other != NULL) runJob(other);
+        else sleepUntilWork(job);
+    }
+}
+
+/*
+Checks if a job has finished, without blocking
+Parameter: Pointer to the job (*job)
+Returns: true if done. Otherwise, false
+*/
+bool IsJobDone(Job *job) {
+    return atomic_load(&job->done);
+}
+
+/*
+Sets the function called after every job, on the thread that ran it
+Parameter: Function to call, NULL for none (observer)
+*/
+void SetJobObserver(JobObserver observer) {
+    atomic_store(&jobObserver, observer);
+}
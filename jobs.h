@@ -0,0 +1,53 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#define MAX_JOB_WORKERS 16
+#define MAX_JOB_DEPENDENTS 8
+
+typedef void (*JobFunction)(void *data);
+
+// A unit of work. Jobs are owned by the caller and must stay alive until they are done.
+// Jobs are submitted from the main thread or from inside other jobs (each thread has its own deque)
+typedef struct Job {
+    const char *name;
+    JobFunction function;
+    void *data;
+    atomic_int pending;   // Unfinished dependencies (+1 until the job is submitted)
+    atomic_bool done;
+    struct Job *dependents[MAX_JOB_DEPENDENTS]; // Jobs waiting for this one
+    int dependentCount;
+    int worker;          // Thread that ran the job (0 is the main thread)
+    double startTime;    // GetPreciseTime() when the job started and finished
+    double endTime;
+} Job;
+
+// Called by the thread that ran a job, right after it finished (e.g. to trace it)
+typedef void (*JobObserver)(const Job *job);
+
+// functions
+void InitJobSystem(int threadCount);
+void ShutdownJobSystem(void);
+int GetJobWorkerCount(void);
+void InitJob(Job *job, const char *name, JobFunction function, void *data);
+void AddJobDependency(Job *job, Job *dependency);
+void SubmitJob(Job *job);
+void WaitForJob(Job *job);
+bool IsJobDone(Job *job);
+void SetJobObserver(JobObserver observer);
+
+#endif
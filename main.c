@@ -12,23 +12,38 @@
 
 #include <time.h>
 #include <stdio.h> // Required for sprintf
+#include <stdlib.h>
+#include <string.h>
 #include "raylib.h"
 #include "raymath.h"
 #include "helpers.h"
 #include "drawTextures.h"
+#include "assetLoader.h"
+#include "platform.h"
+#include "minimap.h"
+#include "simulation.h"
+#include "headless.h"
+#include "profiler.h"
+#include "flowField.h"
 
 // --- GAME CONSTANTS ---
 const int INITIAL_WINDOW_WIDTH = 1300; 
 const int INITIAL_WINDOW_HEIGHT = 800;
 const int DELIVERY_BIKE_RENDER_SIZE = 32;
-const int DELIVERY_BIKE_SCALED_SIZE = 20;
-const int SPEED_CONSTANT = 2;
+const int DELIVERY_BIKE_SCALED_SIZE = PLAYER_SIZE;
 const Color BACKGROUND_COLOR = DARKGRAY;
+const int FALLBACK_FPS = 60; // Frame cap when the monitor's refresh rate can't be read
 
 const int MINIMAP_WIDTH = 150;      
 const int MINIMAP_HEIGHT = 150;     
 const float MINIMAP_ZOOM = 0.3f;    
+const float MINIMAP_UPDATE_RATE = 10.0f; // Overlay (vehicles, targets) redraws per second
 const int MINIMAP_BORDER = 2;
+const int ARROW_LOOKAHEAD = 8; // Cells of the route (FLOW_CELL_SIZE pixels each) that the arrow looks ahead
+
+// --- TRAFFIC CONSTANTS ---
+const int TRAFFIC_LEVELS[] = { 20, 200, 2000, 20000, 200000 }; // Steps of the options' traffic buttons
+const int TRAFFIC_LEVEL_COUNT = sizeof(TRAFFIC_LEVELS) / sizeof(TRAFFIC_LEVELS[0]);
 
 // --- UI CONSTANTS ---
 const int BUTTON_WIDTH = 220;
@@ -37,34 +52,76 @@ const int FONT_SIZE = 20;
 
 // Global State Variables
 bool showOrders = false;
-int count = 0; // Number of orders completed
-float totalMoney = 0.0f;
 float difficultyFactor = 0.5f; 
 
 /* Program's main function
 Initiates window, loads media (image/sound) and runs game loop using the states Menu, Gameplay and Options
+Usage: DeliveryRush [--vehicles N] [--threads T] [--seed S] [--profiler] [--trace SECONDS] [--headless [--sessions K] [--seconds D] [--player idle|bot]]
+N sets the starting traffic density (also adjustable in the options), T the number of threads that share the work
+(including this one, default one per CPU core) and S the seed of the random numbers (default: the clock).
+--profiler shows the frame profiler from the start (F3 toggles it). --trace saves a trace of the first SECONDS, loading included (F4 starts one later).
+--headless plays K sessions of D seconds (default 1 and 240) with no window, audio or GPU, as fast as possible, and prints the results
 */
-int main(void) {
+int main(int argc, char **argv) {
+  
+  unsigned int seed = (unsigned int)time(NULL);
+  int trafficDensity = DEFAULT_VEHICLES;
+  int threadCount = 0;
+  bool headless = false;
+  bool showProfiler = false;
+  float traceSeconds = 0.0f;
+  HeadlessOptions headlessOptions = { 0, 1, GAME_DURATION, HEADLESS_PLAYER_BOT };
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--vehicles") == 0 && i + 1 < argc) trafficDensity = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threadCount = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+    else if (strcmp(argv[i], "--headless") == 0) headless = true;
+    else if (strcmp(argv[i], "--profiler") == 0) showProfiler = true;
+    else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) traceSeconds = (float)atof(argv[++i]);
+    else if (strcmp(argv[i], "--sessions") == 0 && i + 1 < argc) headlessOptions.sessions = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) headlessOptions.sessionLength = (float)atof(argv[++i]);
+    else if (strcmp(argv[i], "--player") == 0 && i + 1 < argc) {
+      headlessOptions.player = (strcmp(argv[++i], "idle") == 0) ? HEADLESS_PLAYER_IDLE : HEADLESS_PLAYER_BOT;
+    }
+  }
+  if (trafficDensity < 0) trafficDensity = 0;
+  if (trafficDensity > MAX_VEHICLES) trafficDensity = MAX_VEHICLES;
+
+  SetRandomSeed(seed);
+
+  // --- HEADLESS RUN ---
+  // Same simulation, no window: for benchmarks and soak tests on machines without a GPU
+  if (headless) {
+    InitJobSystem(threadCount);
+    headlessOptions.vehicles = trafficDensity;
+    int result = RunHeadless(headlessOptions);
+    ShutdownJobSystem();
+    return result;
+  }
   
-  SetRandomSeed(time(NULL)); 
+  // --- LOAD ASSETS ---
+  // Decoding and map preprocessing start on worker threads while the window and the audio device open
+  AssetLoader loader;
+  InitJobSystem(threadCount);
+  if (traceSeconds > 0) StartProfilerCapture(traceSeconds);
+  BeginAssetLoading(&loader);
   
   // This allows the game's internal resolution to update when entering Fullscreen
+  double stageStart = GetPreciseTime();
   SetConfigFlags(FLAG_WINDOW_RESIZABLE | FLAG_VSYNC_HINT);
   InitWindow(INITIAL_WINDOW_WIDTH, INITIAL_WINDOW_HEIGHT, "Delivery Rush");
+  RecordStartupStage(&loader, "open window", stageStart);
   
-  // --- LOAD ASSETS ---
-  Texture2D background = LoadTexture("assets/map.jpg"); 
-  Image backgroundWithBorders = LoadImage("assets/mapWithBorders.png");
-  
-  // Analyze map for houses/restaurants
-  InitMapLocations(backgroundWithBorders);
-  Order currentOrder = CreateNewOrder();
-  
-  SetTextureFilter(background, TEXTURE_FILTER_POINT);
-  
+  stageStart = GetPreciseTime();
   InitAudioDevice();
-  Music backgroundMusic = LoadMusicStream("assets/background_music.mp3");
-  Sound horn = LoadSound("assets/horn.mp3");
+  RecordStartupStage(&loader, "open audio device", stageStart);
+  
+  // GPU and audio uploads happen here, on the main thread
+  GameAssets assets = FinishAssetLoading(&loader);
+  MapTiles *background = &assets.background;
+  MapData mapData = assets.map; // Map's bitmasks, houses and restaurants (baked or from the cache)
+  Music backgroundMusic = assets.backgroundMusic;
+  Sound horn = assets.horn;
 
   // Volume State
   float musicVolume = 0.5f;
@@ -72,12 +129,16 @@ int main(void) {
   SetMusicVolume(backgroundMusic, musicVolume);
   SetSoundVolume(horn, sfxVolume);
   
-  int mapHeight = background.height;
-  int mapWidth = background.width;
+  int mapHeight = background->height;
+  int mapWidth = background->width;
   
-  SetTargetFPS(60);
+  // The simulation runs at its own rate, see simulation.h. raylib reports 0 when it can't read the refresh rate,
+  // which would mean no frame cap at all
+  int refreshRate = GetMonitorRefreshRate(GetCurrentMonitor());
+  SetTargetFPS((refreshRate > 0) ? refreshRate : FALLBACK_FPS);
 
   // --- PREPARE TEXTURES ---
+  stageStart = GetPreciseTime();
   RenderTexture2D deliveryBikeRender = LoadRenderTexture(DELIVERY_BIKE_RENDER_SIZE, DELIVERY_BIKE_RENDER_SIZE);
   DrawDeliveryBike(deliveryBikeRender); 
   
@@ -85,7 +146,13 @@ int main(void) {
     0, 0, deliveryBikeRender.texture.width, -deliveryBikeRender.texture.height
   };
   
-  Rectangle deliveryBike = {mapWidth / 2.0f, mapHeight / 2.0f, DELIVERY_BIKE_SCALED_SIZE, DELIVERY_BIKE_SCALED_SIZE};
+  // --- SESSION ---
+  // Player, timers and orders. Advanced in fixed ticks, see simulation.h
+  Vector2 startPos = { mapWidth / 2.0f, mapHeight / 2.0f };
+  Simulation sim = { 0 };
+  ResetSimulation(&sim, startPos, DELIVERY_BIKE_SCALED_SIZE);
+  float accumulator = 0.0f; // Time not simulated yet, less than a tick
+  float alpha = 0.0f;       // Same, as a fraction of a tick
   
   // --- CAMERAS ---
   Camera2D cam = {0};
@@ -93,13 +160,13 @@ int main(void) {
   cam.zoom = 3;
   cam.rotation = 0;
   
-  Camera2D minimapCam = {0};
-  minimapCam.zoom = MINIMAP_ZOOM;
+  Minimap *minimap = &assets.minimap; // Pre-baked base + overlay, no camera needed
+  FlowField guide = LoadFlowField(mapData.width, mapData.height); // Way to the order's target, for the arrow and the minimap
   
   // --- TRAFFIC GENERATION ---
-  Vehicle vehicles[MAX_VEHICLES];
+  VehicleStore vehicles = LoadVehicleStore(trafficDensity, mapData.width, mapData.height);
   // Passing player pos ensures cars don't spawn on top of you
-  vehicleGenerator(MAX_VEHICLES, vehicles, background.height, background.width, backgroundWithBorders, (Vector2){deliveryBike.x, deliveryBike.y});
+  vehicleGenerator(&vehicles, trafficDensity, &mapData, startPos);
 
   RenderTexture2D carTex = LoadRenderTexture(40, 65);
   RenderTexture2D truckTex = LoadRenderTexture(65, 110);
@@ -107,39 +174,31 @@ int main(void) {
   PrepareCarTexture(carTex);
   PrepareTruckTexture(truckTex);
   PreparePoliceTexture(policeTex);
+  RecordStartupStage(&loader, "render sprites", stageStart);
+  LogStartupTimings(&loader);
   
   PlayMusicStream(backgroundMusic);
+  SetProfilerEnabled(showProfiler);
 
   // --- GAMEPLAY VARIABLES ---
   GameState currentState = STATE_MENU; // Start at Menu
-  int rotation = 0;
-
-  // timer to end run
-  const float GAME_DURATION = 240.0f; // 4 Minutes in seconds
-  float globalTimer = GAME_DURATION;
-  
-  OrderStatusMessage message;
-  message.messageType = PENDING;
-  message.timer = 0;
-
-  float lastReward = 0;
-  
-  // Respawn / Stuck Logic
-  float collisionDuration = 0.0f;
-  float respawnTimer = 0.0f;
-  bool isRespawning = false;
 
   bool exitRequest = false;
   bool running = true;
 
   // --- MAIN LOOP ---
   while (running) {
+    ProfilerNewFrame();
+    ProfileBegin(PROFILE_MUSIC);
     UpdateMusicStream(backgroundMusic);
+    ProfileEnd(PROFILE_MUSIC);
 
     float screenHeight = (float)GetScreenHeight();
     float screenWidth = (float)GetScreenWidth();
 
     if (IsKeyPressed(KEY_F)) ToggleFullscreen();
+    if (IsKeyPressed(KEY_F3)) SetProfilerEnabled(!profilerEnabled);
+    if (IsKeyPressed(KEY_F4)) StartProfilerCapture((traceSeconds > 0) ? traceSeconds : DEFAULT_TRACE_SECONDS);
 
     if (IsWindowFullscreen()) {
         int monitor = GetCurrentMonitor();
@@ -152,7 +211,7 @@ int main(void) {
     }
 
     Vector2 arrowPos = {0};
-    Vector2 bikePos;
+    Vector2 bikePos = GetInterpolatedBikePosition(&sim, alpha);
     float angleToTarget = 0.0f;
 
     // ==========================================
@@ -160,120 +219,44 @@ int main(void) {
     // ==========================================
 
     if (currentState == STATE_GAMEPLAY && !exitRequest) {
-        
-        globalTimer -= GetFrameTime();
-        if (globalTimer <= 0) {
-            globalTimer = 0;
-            currentState = STATE_GAMEOVER;
+
+        // 1. Simulation: as many fixed ticks as fit in the time that passed, the rest carries over to the next frame
+        ProfileBegin(PROFILE_SIMULATION);
+        PlayerInput input = { IsKeyDown(KEY_W), IsKeyDown(KEY_S), IsKeyDown(KEY_A), IsKeyDown(KEY_D) };
+        accumulator += GetFrameTime();
+        if (accumulator > MAX_TICKS_PER_FRAME * SIMULATION_TICK) accumulator = MAX_TICKS_PER_FRAME * SIMULATION_TICK;
+        while (accumulator >= SIMULATION_TICK && !sim.isOver) {
+            StepSimulation(&sim, input, &vehicles, &mapData);
+            accumulator -= SIMULATION_TICK;
         }
+        if (sim.isOver) currentState = STATE_GAMEOVER;
+        alpha = accumulator / SIMULATION_TICK;
+        ProfileEnd(PROFILE_SIMULATION);
+
+        if (sim.isColliding && !IsSoundPlaying(horn)) PlaySound(horn);
+
+        // Everything below follows the player where it is drawn, between the last two ticks
+        bikePos = GetInterpolatedBikePosition(&sim, alpha);
 
-        // 1. Traffic & Orders
-        updateTraffic(vehicles, MAX_VEHICLES, backgroundWithBorders, (Vector2){deliveryBike.x, deliveryBike.y});
-        
-        bikePos = (Vector2){ deliveryBike.x, deliveryBike.y };
-        updateOrder(&currentOrder, bikePos, &count, &totalMoney, houses, houseCount, &message, &lastReward);
-        
         // 2. Arrow Logic
+        ProfileBegin(PROFILE_CAMERA);
         Vector2 currentTargetPos;
-        if (!currentOrder.foodPickedUp) currentTargetPos = currentOrder.pickupLocation;
-        else currentTargetPos = currentOrder.dropoffLocation;
+        if (!sim.order.foodPickedUp) currentTargetPos = sim.order.pickupLocation;
+        else currentTargetPos = sim.order.dropoffLocation;
         
-        angleToTarget = atan2f(currentTargetPos.y - bikePos.y, currentTargetPos.x - bikePos.x);
+        // Along the roads: the arrow aims at a point a little further down the route, straight at the target
+        // while the route is being searched or if there is none
+        UpdateFlowField(&guide, &mapData, currentTargetPos);
+        Vector2 waypoint;
+        if (!GetFlowWaypoint(&guide, bikePos, ARROW_LOOKAHEAD, &waypoint) || Vector2Distance(waypoint, bikePos) < 1.0f) waypoint = currentTargetPos;
+        angleToTarget = atan2f(waypoint.y - bikePos.y, waypoint.x - bikePos.x);
         float arrowRadius = 45.0f;
         arrowPos = (Vector2){
             bikePos.x + cosf(angleToTarget) * arrowRadius,
             bikePos.y + sinf(angleToTarget) * arrowRadius
         };
 
-        // 3. Movement & Physics
-        float horizontalOffset, verticalOffset;
-
-        if (rotation == 90 || rotation == 270) {
-            horizontalOffset = deliveryBike.height / 2.0f; 
-            verticalOffset = deliveryBike.width / 3.5f;
-        } else {
-            horizontalOffset = deliveryBike.width / 3.5f;
-            verticalOffset = deliveryBike.height / 2.0f;
-        }
-
-        const Vector2 collisionPoints[4] = {
-            {deliveryBike.x, deliveryBike.y - verticalOffset - 1},
-            {deliveryBike.x + horizontalOffset + 1, deliveryBike.y},
-            {deliveryBike.x, deliveryBike.y + verticalOffset + 1},
-            {deliveryBike.x - horizontalOffset - 1, deliveryBike.y}
-        };
-          
-        Rectangle futurePos = deliveryBike;
-          
-        // -- CONTROLS --
-        // MOVE FORWARD (W)
-        if (IsKeyDown(KEY_W)) {
-            futurePos.y -= SPEED_CONSTANT; 
-            bool hitCar = checkCollisionWithVehicles(futurePos, vehicles, MAX_VEHICLES, true);
-            if (!willTouchBorder(backgroundWithBorders, collisionPoints[0]) && !hitCar) {
-                rotation = 0;
-                deliveryBike.y -= SPEED_CONSTANT;
-                isRespawning = false;
-            }
-        }
-        // MOVE BACKWARD (S)
-        if (IsKeyDown(KEY_S)) {
-            futurePos = deliveryBike; futurePos.y += SPEED_CONSTANT;
-            bool hitCar = checkCollisionWithVehicles(futurePos, vehicles, MAX_VEHICLES, true);
-            if (!willTouchBorder(backgroundWithBorders, collisionPoints[2]) && !hitCar) {
-                rotation = 180;
-                deliveryBike.y += SPEED_CONSTANT;
-                isRespawning = false;
-            }
-        }
-        // MOVE LEFT (A)
-        if(IsKeyDown(KEY_A)) {
-            futurePos = deliveryBike; futurePos.x -= SPEED_CONSTANT;
-            bool hitCar = checkCollisionWithVehicles(futurePos, vehicles, MAX_VEHICLES, true);
-            if (!willTouchBorder(backgroundWithBorders, collisionPoints[3]) && !hitCar) {
-                rotation = 270;
-                deliveryBike.x -= SPEED_CONSTANT;
-                isRespawning = false;
-            }
-        }
-        // MOVE RIGHT (D)
-        if (IsKeyDown(KEY_D)) {
-            futurePos = deliveryBike; futurePos.x += SPEED_CONSTANT;
-            bool hitCar = checkCollisionWithVehicles(futurePos, vehicles, MAX_VEHICLES, true);
-            if (!willTouchBorder(backgroundWithBorders, collisionPoints[1]) && !hitCar) {
-                rotation = 90;
-                deliveryBike.x += SPEED_CONSTANT;
-                isRespawning = false;
-            }
-        }
-
-        // 4. Collision / Stuck Logic
-        bool isCollidingNow = checkCollisionWithVehicles(deliveryBike, vehicles, MAX_VEHICLES, false);
-          
-        if (isCollidingNow) {
-            if (!IsSoundPlaying(horn)) PlaySound(horn);
-            if (!isRespawning) collisionDuration += GetFrameTime();
-        } else {
-            collisionDuration = 0.0f;
-        }
-          
-        if (collisionDuration > 1.5f && !isRespawning) {
-            isRespawning = true;
-            respawnTimer = 3.0f; 
-        }
-          
-        if (isRespawning) {
-            respawnTimer -= GetFrameTime();
-            if (respawnTimer <= 0) {
-                Vector2 newPos = GetRandomValidPosition(backgroundWithBorders, vehicles, MAX_VEHICLES, mapWidth, mapHeight);
-                deliveryBike.x = newPos.x;
-                deliveryBike.y = newPos.y;
-                isRespawning = false;
-                collisionDuration = 0.0f;
-            }
-        }
-
-        // 5. Camera Update (With Clamping for Fullscreen)
+        // 3. Camera Update (With Clamping for Fullscreen)
         float visibleWidth = screenWidth / cam.zoom;
         float visibleHeight = screenHeight / cam.zoom;
         
@@ -281,38 +264,40 @@ int main(void) {
         if (mapWidth < visibleWidth) {
             cam.target.x = mapWidth / 2.0f;
         } else {
-            cam.target.x = Clamp(deliveryBike.x, visibleWidth/2.0f, mapWidth - visibleWidth/2.0f);
+            cam.target.x = Clamp(bikePos.x, visibleWidth/2.0f, mapWidth - visibleWidth/2.0f);
         }
 
         // Clamp Camera Y
         if (mapHeight < visibleHeight) {
             cam.target.y = mapHeight / 2.0f;
         } else {
-            cam.target.y = Clamp(deliveryBike.y, visibleHeight/2.0f, mapHeight - visibleHeight/2.0f);
+            cam.target.y = Clamp(bikePos.y, visibleHeight/2.0f, mapHeight - visibleHeight/2.0f);
         }
           
         if (cam.zoom >= 2 && GetMouseWheelMove() < 0) cam.zoom -= 0.2;
         else if (cam.zoom <= 3.6 && GetMouseWheelMove() > 0) cam.zoom += 0.2;
 
-        minimapCam.target.x = deliveryBike.x;
-        minimapCam.target.y = deliveryBike.y;
+        UpdateMinimapOverlay(minimap, GetFrameTime(), bikePos, &vehicles, &sim.order, &guide);
+        ProfileEnd(PROFILE_CAMERA);
         
-        // 6. Inputs
+        // 4. Inputs
         if (IsKeyPressed(KEY_K)) showOrders = !showOrders;
     }
 
     // ==========================================
     // DRAWING
     // ==========================================
+    ProfileBegin(PROFILE_TILE_STREAMING);
+    UpdateMapTiles(background); // Streams in the tiles around last frame's views
+    ProfileEnd(PROFILE_TILE_STREAMING);
     BeginDrawing();
       ClearBackground((Color){0, 0, 0, 204});
 
       // --- COMMON MENU BACKGROUND DRAWING LOGIC ---
       // This is used for all states EXCEPT Gameplay.
-      // It uses the Origin Vector to perfectly center the map without stretching.
-      Rectangle bgSource = { 0.0f, 0.0f, (float)background.width, (float)background.height };
-      Rectangle bgDest   = { screenWidth / 2.0f, screenHeight / 2.0f, (float)background.width, (float)background.height };
-      Vector2   bgOrigin = { (float)background.width / 2.0f, (float)background.height / 2.0f };
+      // The offset centers the map without stretching, the view keeps only the tiles on screen.
+      Vector2   bgOffset = { (screenWidth - mapWidth) / 2.0f, (screenHeight - mapHeight) / 2.0f };
+      Rectangle bgView   = { -bgOffset.x, -bgOffset.y, screenWidth, screenHeight };
 
       // --- STATE: GAMEPLAY ---
       if (currentState == STATE_GAMEPLAY) {
@@ -320,19 +305,21 @@ int main(void) {
           // Re-center cam offset in case window resized
           cam.offset = (Vector2){screenWidth / 2.0f, screenHeight / 2.0f};
 
+          ProfileBegin(PROFILE_WORLD_DRAW);
+          Rectangle view = GetCameraView(cam, (Rectangle){ 0, 0, screenWidth, screenHeight });
           BeginMode2D(cam);
-            DrawTexture(background, 0, 0, WHITE);
+            DrawMapTiles(background, view, (Vector2){ 0, 0 }, WHITE);
             
             // Draw Order Locations (Circles)
-            if (currentOrder.isActive && !currentOrder.foodPickedUp) {
-                DrawCircleV(currentOrder.pickupLocation, 7.5f, Fade(YELLOW, 0.6f));
+            if (sim.order.isActive && !sim.order.foodPickedUp) {
+                DrawCircleV(sim.order.pickupLocation, 7.5f, Fade(YELLOW, 0.6f));
             }
-            if (currentOrder.isActive && currentOrder.foodPickedUp) {
-                DrawCircleV(currentOrder.dropoffLocation, 7.5f, Fade(YELLOW, 0.6f));
+            if (sim.order.isActive && sim.order.foodPickedUp) {
+                DrawCircleV(sim.order.dropoffLocation, 7.5f, Fade(YELLOW, 0.6f));
             }
             
             // Draw Arrow
-            if (currentOrder.isActive)  {
+            if (sim.order.isActive)  {
                 float tipLength = 20.0f;
                 float wingLength = 15.0f;
                 float wingAngle = 5.0f; 
@@ -343,21 +330,25 @@ int main(void) {
                 DrawTriangleLines(tip, leftWing, rightWing, BLACK); 
             }
             
-            // Vehicles
-            for (int i = 0; i < MAX_VEHICLES; i++) {
-              RenderVehicle(vehicles[i], carTex, truckTex, policeTex);
+            // Vehicles (only the visible ones, a truck reaches 11 pixels past its center)
+            for (int i = 0; i < vehicles.count; i++) {
+              if (vehicles.x[i] < view.x - 11 || vehicles.x[i] > view.x + view.width + 11 ||
+                  vehicles.y[i] < view.y - 11 || vehicles.y[i] > view.y + view.height + 11) continue;
+              RenderVehicle(&vehicles, i, alpha, carTex, truckTex, policeTex);
             }
                     
             // Player
-            Rectangle destRect = { deliveryBike.x, deliveryBike.y, DELIVERY_BIKE_SCALED_SIZE, DELIVERY_BIKE_SCALED_SIZE };
             Vector2 origin = { DELIVERY_BIKE_SCALED_SIZE / 2, DELIVERY_BIKE_SCALED_SIZE / 2 };
-            DrawTexturePro(deliveryBikeRender.texture, bikeSource, deliveryBike, origin, rotation, WHITE);
+            Rectangle bikeDest = { bikePos.x, bikePos.y, sim.bike.width, sim.bike.height };
+            DrawTexturePro(deliveryBikeRender.texture, bikeSource, bikeDest, origin, sim.rotation, WHITE);
         
           EndMode2D();
+          ProfileEnd(PROFILE_WORLD_DRAW);
 
           // --- GLOBAL TIMER HUD ---
-          int timerSec = (int)globalTimer % 60;
-          int timerMin = (int)globalTimer / 60;
+          ProfileBegin(PROFILE_HUD);
+          int timerSec = (int)sim.globalTimer % 60;
+          int timerMin = (int)sim.globalTimer / 60;
           const char* globalText = TextFormat("%02d:%02d", timerMin, timerSec);
           int gTimerW = 140;
           int gTimerX = screenWidth/2 - gTimerW/2;
@@ -367,57 +358,49 @@ int main(void) {
           DrawRectangleLines(gTimerX, 20, gTimerW, 50, DARKBLUE);
 
           // Draw Text (Red if under 30 seconds, else Black)
-          Color gColor = (globalTimer < 30.0f) ? RED : BLACK;
+          Color gColor = (sim.globalTimer < 30.0f) ? RED : BLACK;
           DrawText(globalText, gTimerX + (gTimerW - MeasureText(globalText, 30))/2, 30, 30, gColor);
+          ProfileEnd(PROFILE_HUD);
           
           // --- MINIMAP ---
+          ProfileBegin(PROFILE_MINIMAP_DRAW);
           int mmX = screenWidth - MINIMAP_WIDTH - 30;
           int mmY = 20;
           
-          minimapCam.offset = (Vector2){ mmX + MINIMAP_WIDTH/2, mmY + MINIMAP_HEIGHT/2 };
-          
           DrawRectangle(mmX - MINIMAP_BORDER, mmY - MINIMAP_BORDER, MINIMAP_WIDTH + MINIMAP_BORDER*2, MINIMAP_HEIGHT + MINIMAP_BORDER*2, WHITE);
           DrawRectangle(mmX, mmY, MINIMAP_WIDTH, MINIMAP_HEIGHT, BLACK); 
           
-          BeginScissorMode(mmX, mmY, MINIMAP_WIDTH, MINIMAP_HEIGHT);
-            BeginMode2D(minimapCam);
-                DrawTexture(background, 0, 0, LIGHTGRAY);
-                for (int i=0; i<MAX_VEHICLES; i++) RenderVehicle(vehicles[i], carTex, truckTex, policeTex);
-                if (currentOrder.isActive && !currentOrder.foodPickedUp) {
-                    // Draw Restaurant (Yellow square)
-                    DrawRectangle((int)currentOrder.pickupLocation.x - 10, (int)currentOrder.pickupLocation.y - 10, 20, 20, YELLOW);
-                } else {
-                    // Draw Delivery House (Yellow square)
-                    DrawRectangle((int)currentOrder.dropoffLocation.x - 10, (int)currentOrder.dropoffLocation.y - 10, 20, 20, YELLOW);
-                }
-                DrawTexturePro(deliveryBikeRender.texture, bikeSource, destRect, origin, rotation, WHITE);
-            EndMode2D();
-          EndScissorMode(); 
+          DrawMinimap(minimap, mmX, mmY, bikePos, LIGHTGRAY);
+          
+          // The player is drawn live, always at the center
+          Rectangle mmPlayer = { mmX + MINIMAP_WIDTH/2.0f, mmY + MINIMAP_HEIGHT/2.0f, DELIVERY_BIKE_SCALED_SIZE * MINIMAP_ZOOM, DELIVERY_BIKE_SCALED_SIZE * MINIMAP_ZOOM };
+          Vector2 mmOrigin = { mmPlayer.width / 2, mmPlayer.height / 2 };
+          DrawTexturePro(deliveryBikeRender.texture, bikeSource, mmPlayer, mmOrigin, sim.rotation, WHITE); 
           DrawRectangleLines(mmX, mmY, MINIMAP_WIDTH, MINIMAP_HEIGHT, BLACK);
+          ProfileEnd(PROFILE_MINIMAP_DRAW);
                 
           // --- HUD: ORDERS ---
-          if (showOrders && currentOrder.foodPickedUp) {
+          ProfileBegin(PROFILE_HUD);
+          if (showOrders && sim.order.foodPickedUp) {
             DrawRectangle (10, 10, 260, 150, Fade(WHITE, 0.9f));
             DrawRectangleLines (10, 10, 260, 150, BLACK);
-            DrawText(TextFormat("Order %d:", count+1), 20, 20, 20, BLACK);
-            DrawText(currentOrder.restaurantName, 20, 45, 15, BLACK);
-            float distToHouse = Vector2Distance(bikePos, currentOrder.dropoffLocation);
-            float distRestToHouse = Vector2Distance(currentOrder.pickupLocation, currentOrder.dropoffLocation);
-            float reward = 5.0f + (distRestToHouse * 0.015f); // Approximation for display
+            DrawText(TextFormat("Order %d:", sim.count+1), 20, 20, 20, BLACK);
+            DrawText(sim.order.restaurantName, 20, 45, 15, BLACK);
+            float distToHouse = Vector2Distance(bikePos, sim.order.dropoffLocation);
             DrawText(TextFormat("Distance: %.1f m", distToHouse), 20, 70, 20, BLACK);
-            DrawText(TextFormat("Max reward: $%.2f", reward), 20, 92.5f, 20, DARKGREEN);
-            DrawText(TextFormat("Total Cash: $%.2f", totalMoney), 20, 115, 20, DARKGREEN);  
+            DrawText(TextFormat("Max reward: $%.2f", sim.order.initialReward), 20, 92.5f, 20, DARKGREEN);
+            DrawText(TextFormat("Total Cash: $%.2f", sim.totalMoney), 20, 115, 20, DARKGREEN);  
           }
           else if (showOrders)  {
             DrawRectangle (10, 10, 220, 100, WHITE);
-            DrawText(TextFormat("%d orders completed", count), 20, 20, 20, BLACK);
-            DrawText(TextFormat("Total Cash: $%.2f", totalMoney), 20, 50, 20, DARKGREEN);
+            DrawText(TextFormat("%d orders completed", sim.count), 20, 20, 20, BLACK);
+            DrawText(TextFormat("Total Cash: $%.2f", sim.totalMoney), 20, 50, 20, DARKGREEN);
         }
           
           // --- HUD: TIMER ---
-          if (currentOrder.isActive && currentOrder.foodPickedUp) {
-            int minutes = (int)currentOrder.timeRemaining / 60;
-            int seconds = (int)currentOrder.timeRemaining % 60;
+          if (sim.order.isActive && sim.order.foodPickedUp) {
+            int minutes = (int)sim.order.timeRemaining / 60;
+            int seconds = (int)sim.order.timeRemaining % 60;
             const char* timerText = TextFormat("%02d:%02d", minutes, seconds);
             int boxWidth = 160;
             int boxHeight = 80;            
@@ -426,29 +409,30 @@ int main(void) {
               
             DrawRectangle(boxX, boxY, boxWidth, boxHeight, Fade(WHITE, 0.9f));
             DrawRectangleLines(boxX, boxY, boxWidth, boxHeight, BLACK); 
-            Color timerColor = (currentOrder.timeRemaining < 10.0f) ? RED : BLACK;
+            Color timerColor = (sim.order.timeRemaining < 10.0f) ? RED : BLACK;
             DrawText("Time:", boxX + 15, boxY + 5, 10, DARKGRAY);
             DrawText(timerText, boxX + 20, boxY + 25, 40, timerColor); 
           }
 
           // Messages (Success/Fail)
-          if (message.messageType != PENDING) {
-            displayOrderMessage(&message, lastReward);
+          if (sim.message.messageType != PENDING) {
+            displayOrderMessage(&sim.message, sim.lastReward);
           }
           
           // Respawn UI
-          if (isRespawning) {
+          if (sim.isRespawning) {
             const char* text1 = "CAN NOT MOVE";
-            const char* text2 = TextFormat("Respawning in %.1f...", respawnTimer);
+            const char* text2 = TextFormat("Respawning in %.1f...", sim.respawnTimer);
             DrawText(text1, screenWidth/2 - MeasureText(text1, 50)/2, 100, 50, RED);
             DrawText(text2, screenWidth/2 - MeasureText(text2, 40)/2, 160, 40, RED);
           }
+          ProfileEnd(PROFILE_HUD);
       } 
       
       // --- STATE: GAME OVER ---
       else if (currentState == STATE_GAMEOVER) {
         // 1. Background (Centered)
-        DrawTexturePro(background, bgSource, bgDest, bgOrigin, 0.0f, DARKGRAY);
+        DrawMapTiles(background, bgView, bgOffset, DARKGRAY);
         DrawRectangle(0, 0, screenWidth, screenHeight, Fade(BLACK, 0.4f));
 
         int centerX = screenWidth / 2;
@@ -470,8 +454,8 @@ int main(void) {
         // Stats Text
         DrawText("SESSION RESULTS", centerX - MeasureText("SESSION RESULTS", 30)/2, panelY + 20, 30, GOLD);
 
-        const char* txtOrders = TextFormat("Total Deliveries: %d", count);
-        const char* txtMoney = TextFormat("Total Earnings: $%.2f", totalMoney);
+        const char* txtOrders = TextFormat("Total Deliveries: %d", sim.count);
+        const char* txtMoney = TextFormat("Total Earnings: $%.2f", sim.totalMoney);
 
         DrawText(txtOrders, centerX - MeasureText(txtOrders, 25)/2, panelY + 80, 25, WHITE);
         DrawText(txtMoney, centerX - MeasureText(txtMoney, 25)/2, panelY + 120, 25, GREEN);
@@ -482,16 +466,10 @@ int main(void) {
         // PLAY AGAIN BUTTON
         if (DrawButton("PLAY AGAIN", (Rectangle){centerX - BUTTON_WIDTH - 20, btnY, BUTTON_WIDTH, BUTTON_HEIGHT}, FONT_SIZE, ORANGE, DARKGREEN, BLACK)) {
             // --- RESET VARIABLES ---
-            count = 0;
-            totalMoney = 0.0f;
-            globalTimer = GAME_DURATION;
-            currentOrder = CreateNewOrder();
-            
-            deliveryBike.x = mapWidth / 2.0f;
-            deliveryBike.y = mapHeight / 2.0f;
+            ResetSimulation(&sim, startPos, DELIVERY_BIKE_SCALED_SIZE);
+            accumulator = 0.0f;
             deliveryBikeRender = LoadRenderTexture(DELIVERY_BIKE_RENDER_SIZE, DELIVERY_BIKE_RENDER_SIZE);
             DrawDeliveryBike(deliveryBikeRender);
-            rotation = 0;
             
             currentState = STATE_GAMEPLAY;
         }
@@ -499,15 +477,8 @@ int main(void) {
         // MAIN MENU BUTTON
         if (DrawButton("MAIN MENU", (Rectangle){centerX + 20, btnY, BUTTON_WIDTH, BUTTON_HEIGHT}, FONT_SIZE, ORANGE, RED, BLACK)) {
             // --- RESET VARIABLES ---
-            count = 0;
-            totalMoney = 0.0f;
-            globalTimer = GAME_DURATION;
-            currentOrder = CreateNewOrder();
-            
-            // Reset Player Position
-            deliveryBike.x = mapWidth / 2.0f;
-            deliveryBike.y = mapHeight / 2.0f;
-            rotation = 0;
+            ResetSimulation(&sim, startPos, DELIVERY_BIKE_SCALED_SIZE);
+            accumulator = 0.0f;
 
             currentState = STATE_MENU;
         }
@@ -516,7 +487,7 @@ int main(void) {
       // --- STATE: MENU ---
       else if (currentState == STATE_MENU) {
           // 1. Background (Centered)
-          DrawTexturePro(background, bgSource, bgDest, bgOrigin, 0.0f, DARKGRAY);
+          DrawMapTiles(background, bgView, bgOffset, DARKGRAY);
           
           const char* title = "DELIVERY RUSH";
           int titleWidth = MeasureText(title, 60);
@@ -545,12 +516,12 @@ int main(void) {
 
       // --- STATE: OPTIONS ---
       else if (currentState == STATE_OPTIONS) {
-          DrawTexturePro(background, bgSource, bgDest, bgOrigin, 0.0f, DARKGRAY);
+          DrawMapTiles(background, bgView, bgOffset, DARKGRAY);
           DrawText("OPTIONS", screenWidth/2 - MeasureText("OPTIONS", 50)/2, 80, 50, RAYWHITE);
 
           float centerX = screenWidth / 2.0f - BUTTON_WIDTH / 2.0f;
           // Calculate dynamic vertical start point
-          float y = screenHeight / 2.0f - 150; 
+          float y = screenHeight / 2.0f - 200; 
 
           // Screen Size
           DrawText("Display", centerX, y, 20, RAYWHITE);
@@ -600,6 +571,24 @@ int main(void) {
           }
           y += 100;
 
+          // Traffic density: steps through TRAFFIC_LEVELS (a value from --vehicles snaps to the next level)
+          char trafficText[40];
+          sprintf(trafficText, "Traffic: %d vehicles", vehicles.count);
+          DrawText(trafficText, centerX, y, 20, RAYWHITE);
+
+          int newDensity = vehicles.count;
+          if (DrawButton("-", (Rectangle){centerX, y + 25, 50, 35}, 20, LIGHTGRAY, WHITE, BLACK)) {
+              newDensity = 0;
+              for (int l = 0; l < TRAFFIC_LEVEL_COUNT; l++) if (TRAFFIC_LEVELS[l] < vehicles.count) newDensity = TRAFFIC_LEVELS[l];
+          }
+          if (DrawButton("+", (Rectangle){centerX + 170, y + 25, 50, 35}, 20, LIGHTGRAY, WHITE, BLACK)) {
+              for (int l = TRAFFIC_LEVEL_COUNT - 1; l >= 0; l--) if (TRAFFIC_LEVELS[l] > vehicles.count) newDensity = TRAFFIC_LEVELS[l];
+          }
+          if (newDensity != vehicles.count) {
+              setTrafficDensity(&vehicles, newDensity, &mapData, (Vector2){ sim.bike.x, sim.bike.y });
+          }
+          y += 100;
+
           if (DrawButton("BACK", (Rectangle){centerX, y, BUTTON_WIDTH, BUTTON_HEIGHT}, FONT_SIZE, ORANGE, WHITE, BLACK)) {
               currentState = STATE_MENU;
           }
@@ -609,7 +598,7 @@ int main(void) {
       // --- STATE: CONTROLS ---
       else if (currentState == STATE_CONTROLS) {
             // 1. Draw Background
-            DrawTexturePro(background, bgSource, bgDest, bgOrigin, 0.0f, DARKGRAY);
+            DrawMapTiles(background, bgView, bgOffset, DARKGRAY);
             DrawRectangle(0, 0, screenWidth, screenHeight, Fade(BLACK, 0.4f));
 
             int centerX = screenWidth / 2;
@@ -666,7 +655,7 @@ int main(void) {
     // --- STATE: ABOUT CREATORS ---
     else if (currentState == STATE_ABOUT_CREATORS) {
         // 1. Background
-        DrawTexturePro(background, bgSource, bgDest, bgOrigin, 0.0f, DARKGRAY);
+        DrawMapTiles(background, bgView, bgOffset, DARKGRAY);
         DrawRectangle(0, 0, screenWidth, screenHeight, Fade(BLACK, 0.7f)); 
 
         int centerX = screenWidth / 2;
@@ -785,20 +774,26 @@ int main(void) {
             exitRequest = false;
         }
       } 
+
+      DrawProfiler(10, (int)screenHeight - 270);
+    ProfileBegin(PROFILE_PRESENT);
     EndDrawing();
+    ProfileEnd(PROFILE_PRESENT);
   }
   
   // --- CLEANUP ---
-  UnloadTexture(background);
-  UnloadImage(backgroundWithBorders);
+  StopProfilerCapture();
+  UnloadFlowField(&guide); // Before the map, its search may still be reading it
+  UnloadGameAssets(&assets);
+  UnloadVehicleStore(&vehicles);
+  UnloadMapLocations();
   UnloadRenderTexture(carTex);
   UnloadRenderTexture(truckTex);
   UnloadRenderTexture(policeTex);
   UnloadRenderTexture(deliveryBikeRender);
-  UnloadMusicStream(backgroundMusic);
-  UnloadSound(horn);
   CloseAudioDevice();
   CloseWindow();
+  ShutdownJobSystem();
 
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,285 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "raylib.h"
+#include "helpers.h"
+#include "mapCache.h"
+
+// Every section starts at a multiple of this, so the arrays can be used straight from the mapping
+#define SECTION_ALIGNMENT 64
+
+typedef enum {
+    SECTION_WALLS = 1,
+    SECTION_WALL_DISTANCE,
+    SECTION_POSE_MASKS,
+    SECTION_RESTAURANTS,
+    SECTION_HOUSES,
+    SECTION_ROAD_GRAPH,
+    SECTION_DELIVERY_DISTANCES,
+    SECTION_COUNT
+} CacheSection;
+
+typedef struct {
+    char magic[4]; // "DRMC"
+    uint32_t version;
+    uint64_t sourceHash; // Hash of the PNG the cache was baked from
+    int32_t width;
+    int32_t height;
+    int32_t wordsPerRow;
+    uint32_t sectionCount;
+} CacheHeader;
+
+typedef struct {
+    uint32_t id;
+    uint32_t reserved;
+    uint64_t offset; // From the start of the file
+    uint64_t size;   // In bytes
+} CacheSectionEntry;
+
+typedef struct {
+    uint32_t id;
+    const void *data;
+    uint64_t size;
+} SectionSource;
+
+/*
+Hashes the contents of a file (64-bit FNV-1a)
+Parameter: File's path (*path)
+Returns: File's hash, 0 if it can't be read
+*/
+uint64_t HashFileContents(const char *path) {
+    int size = 0;
+    unsigned char *data = LoadFileData(path, &size);
+    if (data == NULL) return 0;
+
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+
+    UnloadFileData(data);
+    return hash;
+}
+
+/*
+Finds a section of a mapped cache and checks that it fits inside the file
+Parameters: Pointer to the mapping (*file), section's id (id) and its expected size in bytes (size)
+Returns: Pointer to the section's data, NULL if missing or invalid
+*/
+static const void *findSection(const MappedFile *file, uint32_t id, uint64_t size) {
+    const CacheHeader *header = file->data;
+    const CacheSectionEntry *entries = (const CacheSectionEntry *)(header + 1);
+
+    for (uint32_t i = 0; i < header->sectionCount; i++) {
+        if (entries[i].id != id) continue;
+        if (entries[i].size != size || entries[i].offset % SECTION_ALIGNMENT != 0) return NULL;
+        if (entries[i].offset > file->size || entries[i].size > file->size - entries[i].offset) return NULL;
+        return (const unsigned char *)file->data + entries[i].offset;
+    }
+    return NULL;
+}
+
+/*
+Finds the size of a section (for arrays whose length isn't known in advance)
+Parameters: Pointer to the mapping (*file) and section's id (id)
+Returns: Section's size in bytes, 0 if missing
+*/
+static uint64_t sectionSize(const MappedFile *file, uint32_t id) {
+    const CacheHeader *header = file->data;
+    const CacheSectionEntry *entries = (const CacheSectionEntry *)(header + 1);
+
+    for (uint32_t i = 0; i < header->sectionCount; i++) {
+        if (entries[i].id == id) return entries[i].size;
+    }
+    return 0;
+}
+
+/*
+Copies the buildings of a cache section into a new array
+Parameters: Pointer to the mapping (*file), section's id (id) and pointer to the number of buildings (*count)
+Returns: Pointer to the array (NULL if empty or invalid)
+*/
+static Building *loadBuildings(const MappedFile *file, uint32_t id, int *count) {
+    uint64_t size = sectionSize(file, id);
+    *count = 0;
+    if (size == 0 || size % sizeof(Building) != 0) return NULL;
+
+    const void *data = findSection(file, id, size);
+    if (data == NULL) return NULL;
+
+    Building *buildings = malloc(size);
+    memcpy(buildings, data, size);
+    *count = (int)(size / sizeof(Building));
+    return buildings;
+}
+
+/*
+Maps a map cache and points map's data into it, if it was baked from the same source image
+Parameters: Cache's path (*cachePath), source image's hash (sourceHash) and pointer to map's data to fill (*map)
+Returns: true if the cache is valid and was loaded. Otherwise, false
+*/
+bool LoadMapCache(const char *cachePath, uint64_t sourceHash, MapData *map) {
+    MappedFile file;
+    if (!MapFileReadOnly(cachePath, &file)) return false;
+
+    const CacheHeader *header = file.data;
+    bool valid = file.size >= sizeof(CacheHeader) && memcmp(header->magic, "DRMC", 4) == 0 &&
+                 header->version == MAP_CACHE_VERSION && header->sourceHash == sourceHash &&
+                 header->width > 0 && header->height > 0 && header->wordsPerRow == (header->width + 63) / 64 &&
+                 header->sectionCount < SECTION_COUNT * 4 &&
+                 file.size >= sizeof(CacheHeader) + header->sectionCount * sizeof(CacheSectionEntry);
+    if (!valid) {
+        UnmapFile(&file);
+        return false;
+    }
+
+    MapData loaded = {0};
+    loaded.width = header->width;
+    loaded.height = header->height;
+    loaded.wordsPerRow = header->wordsPerRow;
+
+    uint64_t bitsetSize = (uint64_t)loaded.wordsPerRow * loaded.height * sizeof(uint64_t);
+    loaded.wallBits = (uint64_t *)findSection(&file, SECTION_WALLS, bitsetSize);
+    loaded.wallDistance = (uint8_t *)findSection(&file, SECTION_WALL_DISTANCE, (uint64_t)loaded.width * loaded.height);
+
+    const unsigned char *poses = findSection(&file, SECTION_POSE_MASKS, bitsetSize * POSE_MASK_COUNT);
+    for (int i = 0; i < POSE_MASK_COUNT && poses != NULL; i++) loaded.poseBits[i] = (uint64_t *)(poses + bitsetSize * i);
+
+    uint64_t roadsSize = sectionSize(&file, SECTION_ROAD_GRAPH);
+    bool roadsValid = LoadRoadGraph(&loaded.roads, findSection(&file, SECTION_ROAD_GRAPH, roadsSize), roadsSize);
+
+    if (loaded.wallBits == NULL || loaded.wallDistance == NULL || poses == NULL || !roadsValid) {
+        UnmapFile(&file);
+        return false;
+    }
+
+    // Buildings are small, copy them so that the rest of the game can own them as usual
+    UnloadMapLocations();
+    restaurants = loadBuildings(&file, SECTION_RESTAURANTS, &restaurantCount);
+    houses = loadBuildings(&file, SECTION_HOUSES, &houseCount);
+    uint64_t distancesSize = (uint64_t)restaurantCount * houseCount * sizeof(float);
+    const void *distances = findSection(&file, SECTION_DELIVERY_DISTANCES, distancesSize);
+    if (distances != NULL && distancesSize > 0) {
+        deliveryDistances = malloc(distancesSize);
+        memcpy(deliveryDistances, distances, distancesSize);
+    }
+
+    loaded.cache = file;
+    BuildSpawnTables(&loaded); // Cheap to rebuild, so it isn't stored
+    loaded.router = BuildRoadRouter(loaded.roads, ROUTER_LANDMARKS); // Same
+    BuildRoadLanes(&loaded); // Same
+    InitTrafficDestinations(&loaded); // Same
+    *map = loaded;
+    TraceLog(LOG_INFO, "MAPCACHE: [%s] Loaded %dx%d map, %d restaurants, %d houses, %d road nodes", cachePath, map->width, map->height,
+             restaurantCount, houseCount, map->roads.nodeCount);
+    return true;
+}
+
+/*
+Writes map's data and the buildings found on it to a cache file.
+Writes to a temporary file first, so that a crash never leaves a half written cache behind
+Parameters: Cache's path (*cachePath), source image's hash (sourceHash) and pointer to map's data (*map)
+Returns: true on success. Otherwise, false
+*/
+bool SaveMapCache(const char *cachePath, uint64_t sourceHash, const MapData *map) {
+    uint64_t bitsetSize = (uint64_t)map->wordsPerRow * map->height * sizeof(uint64_t);
+
+    SectionSource sections[] = {
+        { SECTION_WALLS, map->wallBits, bitsetSize },
+        { SECTION_WALL_DISTANCE, map->wallDistance, (uint64_t)map->width * map->height },
+        { SECTION_POSE_MASKS, NULL, bitsetSize * POSE_MASK_COUNT }, // Written mask by mask below
+        { SECTION_RESTAURANTS, restaurants, (uint64_t)restaurantCount * sizeof(Building) },
+        { SECTION_HOUSES, houses, (uint64_t)houseCount * sizeof(Building) },
+        { SECTION_ROAD_GRAPH, map->roads.memory, map->roads.size },
+        { SECTION_DELIVERY_DISTANCES, deliveryDistances, (deliveryDistances != NULL) ? (uint64_t)restaurantCount * houseCount * sizeof(float) : 0 },
+    };
+    int sectionCount = sizeof(sections) / sizeof(sections[0]);
+
+    char tempPath[512];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", cachePath);
+    FILE *file = fopen(tempPath, "wb");
+    if (file == NULL) return false;
+
+    CacheHeader header = { { 'D', 'R', 'M', 'C' }, MAP_CACHE_VERSION, sourceHash, map->width, map->height, map->wordsPerRow, (uint32_t)sectionCount };
+    CacheSectionEntry entries[sizeof(sections) / sizeof(sections[0])];
+
+    uint64_t offset = sizeof(CacheHeader) + sectionCount * sizeof(CacheSectionEntry);
+    for (int i = 0; i < sectionCount; i++) {
+        offset = (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+        entries[i] = (CacheSectionEntry){ sections[i].id, 0, offset, sections[i].size };
+        offset += sections[i].size;
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(entries, sizeof(CacheSectionEntry), sectionCount, file) == (size_t)sectionCount;
+
+    static const unsigned char padding[SECTION_ALIGNMENT] = {0};
+    uint64_t written = sizeof(CacheHeader) + sectionCount * sizeof(CacheSectionEntry);
+    for (int i = 0; i < sectionCount && ok; i++) {
+        ok = fwrite(padding, 1, entries[i].offset - written, file) == entries[i].offset - written;
+
+        if (sections[i].id == SECTION_POSE_MASKS) {
+            for (int p = 0; p < POSE_MASK_COUNT && ok; p++) ok = fwrite(map->poseBits[p], 1, bitsetSize, file) == bitsetSize;
+        } else if (sections[i].size > 0) {
+            ok = ok && fwrite(sections[i].data, 1, sections[i].size, file) == sections[i].size;
+        }
+        written = entries[i].offset + sections[i].size;
+    }
+
+    if (fclose(file) != 0) ok = false;
+    if (ok) {
+        remove(cachePath); // rename() doesn't replace existing files on Windows
+        ok = rename(tempPath, cachePath) == 0;
+    }
+    if (!ok) remove(tempPath);
+    return ok;
+}
+
+/*
+Preprocesses the borders' image (map's data and buildings) and refreshes the cache with the result
+Parameters: Image of map with borders (borders), cache's path (*cachePath) and the image file's hash (sourceHash), 0 to skip the cache
+Returns: Map's data (MapData). Must be freed with UnloadMapData
+*/
+MapData BakeMapData(Image borders, const char *cachePath, uint64_t sourceHash) {
+    MapData map = LoadMapData(borders);
+    InitMapLocations(&map);
+    InitDeliveryDistances(&map);
+    InitTrafficDestinations(&map);
+
+    if (sourceHash != 0 && SaveMapCache(cachePath, sourceHash, &map)) {
+        TraceLog(LOG_INFO, "MAPCACHE: [%s] Cache rebuilt", cachePath);
+    } else {
+        TraceLog(LOG_WARNING, "MAPCACHE: [%s] Failed to write cache", cachePath);
+    }
+    return map;
+}
+
+/*
+Loads map's data (and its buildings) from the cache when it matches the borders' image,
+otherwise decodes the image, preprocesses it and refreshes the cache
+Parameters: Path of the borders' image (*bordersPath) and of the cache (*cachePath)
+Returns: Map's data (MapData). Must be freed with UnloadMapData
+*/
+MapData LoadMapDataCached(const char *bordersPath, const char *cachePath) {
+    MapData map = {0};
+    uint64_t sourceHash = HashFileContents(bordersPath);
+    if (sourceHash != 0 && LoadMapCache(cachePath, sourceHash, &map)) return map;
+
+    Image borders = LoadImage(bordersPath);
+    map = BakeMapData(borders, cachePath, sourceHash);
+    UnloadImage(borders); // Everything we need from it is baked
+    return map;
+}
\ No newline at end of file
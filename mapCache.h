@@ -0,0 +1,30 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+#ifndef MAPCACHE_H
+#define MAPCACHE_H
+
+#include <stdint.h>
+#include "raylib.h"
+#include "mapData.h"
+
+// Bump whenever the layout of the cache or of anything stored in it changes
+#define MAP_CACHE_VERSION 3
+
+// functions
+uint64_t HashFileContents(const char *path);
+bool LoadMapCache(const char *cachePath, uint64_t sourceHash, MapData *map);
+bool SaveMapCache(const char *cachePath, uint64_t sourceHash, const MapData *map);
+MapData BakeMapData(Image borders, const char *cachePath, uint64_t sourceHash);
+MapData LoadMapDataCached(const char *bordersPath, const char *cachePath);
+
+#endif
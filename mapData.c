@@ -0,0 +1,674 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include "raylib.h"
+#include "mapData.h"
+#include "colorClassify.h"
+#include "jobs.h"
+
+/*
+Computes the exact distance of every pixel to the nearest wall (Felzenszwalb-Huttenlocher distance transform)
+in linear time: first the vertical distance per column, then the lower envelope of parabolas per row.
+Pixels outside of the map count as walls
+Parameter: Pointer to map's data (*map) with its wall bits already baked
+*/
+static void buildWallDistance(MapData *map) {
+    int w = map->width;
+    int h = map->height;
+    uint16_t *vertical = malloc((size_t)w * h * sizeof(uint16_t));
+
+    // 1. Vertical pass, row by row so that the inner loops stay cache friendly
+    for (int y = 0; y < h; y++) {
+        uint16_t *row = vertical + (size_t)y * w;
+        for (int x = 0; x < w; x++) {
+            if (IsWallPixel(map, x, y)) row[x] = 0;
+            else row[x] = (y == 0) ? 1 : row[x - w] + 1; // The row above the map is a wall
+        }
+    }
+    for (int y = h - 2; y >= 0; y--) { // The row below the map is a wall too, so the last row is final
+        uint16_t *row = vertical + (size_t)y * w;
+        for (int x = 0; x < w; x++) {
+            uint16_t fromBelow = row[x + w] + 1;
+            if (fromBelow < row[x]) row[x] = fromBelow;
+        }
+    }
+
+    // 2. Horizontal pass: lower envelope of the parabolas (x - q)^2 + vertical(q)^2
+    double *f = malloc(w * sizeof(double));
+    double *z = malloc((w + 1) * sizeof(double));
+    int *v = malloc(w * sizeof(int));
+
+    for (int y = 0; y < h; y++) {
+        const uint16_t *row = vertical + (size_t)y * w;
+        uint8_t *out = map->wallDistance + (size_t)y * w;
+
+        for (int x = 0; x < w; x++) f[x] = (double)row[x] * row[x];
+
+        int k = 0;
+        v[0] = 0;
+        z[0] = -INFINITY;
+        z[1] = INFINITY;
+        for (int q = 1; q < w; q++) {
+            double s = ((f[q] + (double)q * q) - (f[v[k]] + (double)v[k] * v[k])) / (2.0 * (q - v[k]));
+            while (s <= z[k]) {
+                k--;
+                s = ((f[q] + (double)q * q) - (f[v[k]] + (double)v[k] * v[k])) / (2.0 * (q - v[k]));
+            }
+            k++;
+            v[k] = q;
+            z[k] = s;
+            z[k + 1] = INFINITY;
+        }
+
+        k = 0;
+        for (int x = 0; x < w; x++) {
+            while (z[k + 1] < x) k++;
+            double dx = x - v[k];
+            double dist = sqrt(dx * dx + f[v[k]]);
+
+            // The columns left and right of the map are walls too
+            if (dist > x + 1) dist = x + 1;
+            if (dist > w - x) dist = w - x;
+            out[x] = (dist >= 255.0) ? 255 : (uint8_t)dist;
+        }
+    }
+
+    free(v);
+    free(z);
+    free(f);
+    free(vertical);
+}
+
+// --- LANE CONSTANTS ---
+static const float LANE_GAP = 2.0f;        // Space between the two lanes of a road wide enough for them
+static const float LANE_TOLERANCE = 0.05f; // How far off its line (rounding) a vehicle may be and still count as on it
+static const int LANE_MAX_SHIFT = 4;       // Farthest a lane moves sideways from its usual place to get past a narrow spot
+
+// Footprint sizes (width, height) of every pose mask, in pixels
+static const float poseSizes[POSE_MASK_COUNT][2] = {
+    { 8.0f, 13.0f }, { 13.0f, 8.0f }, { 11.0f, 22.0f }, { 22.0f, 11.0f }
+};
+
+typedef struct {
+    MapData *map;
+    PoseMask pose;
+} PoseMaskTask;
+
+/*
+Erodes the road by a vehicle's footprint: a pixel is a valid center if no wall lies within the footprint around it.
+The footprint's reach is rounded up, so that the check holds for any position inside the pixel.
+Runs as a separable min-filter, first along the rows and then along the columns, with sliding window counts
+Parameter: Pointer to the task (*arg) with the map and the pose mask to build
+*/
+static void buildPoseMask(void *arg) {
+    PoseMaskTask *task = arg;
+    MapData *map = task->map;
+    int w = map->width;
+    int h = map->height;
+    int reachX = (int)ceilf(poseSizes[task->pose][0] / 2);
+    int reachY = (int)ceilf(poseSizes[task->pose][1] / 2);
+
+    // 1. Horizontal pass: is there a wall within reachX pixels of the same row?
+    uint8_t *blocked = malloc((size_t)w * h);
+    for (int y = 0; y < h; y++) {
+        uint8_t *row = blocked + (size_t)y * w;
+        int walls = 0;
+        for (int x = -reachX; x <= reachX - 1; x++) walls += IsWallPixel(map, x, y);
+
+        for (int x = 0; x < w; x++) {
+            walls += IsWallPixel(map, x + reachX, y);
+            row[x] = walls > 0;
+            walls -= IsWallPixel(map, x - reachX, y);
+        }
+    }
+
+    // 2. Vertical pass: is there a blocked pixel within reachY rows of the same column?
+    uint64_t *bits = calloc((size_t)map->wordsPerRow * h, sizeof(uint64_t));
+    uint16_t *counts = calloc(w, sizeof(uint16_t));
+
+    for (int y = 0; y < reachY && y < h; y++) {
+        for (int x = 0; x < w; x++) counts[x] += blocked[(size_t)y * w + x];
+    }
+    for (int y = 0; y < h; y++) {
+        int enter = y + reachY;
+        int leave = y - reachY - 1;
+        if (enter < h) {
+            for (int x = 0; x < w; x++) counts[x] += blocked[(size_t)enter * w + x];
+        }
+        if (leave >= 0) {
+            for (int x = 0; x < w; x++) counts[x] -= blocked[(size_t)leave * w + x];
+        }
+
+        // Rows above and below the map are walls
+        if (y - reachY < 0 || y + reachY >= h) continue;
+
+        uint64_t *out = bits + (size_t)y * map->wordsPerRow;
+        for (int x = 0; x < w; x++) {
+            if (counts[x] == 0) out[x >> 6] |= 1ULL << (x & 63);
+        }
+    }
+
+    free(counts);
+    free(blocked);
+    map->poseBits[task->pose] = bits;
+}
+
+/*
+Builds the pose masks of all vehicle footprints as parallel jobs
+Parameter: Pointer to map's data (*map) with its wall bits already baked
+*/
+static void buildPoseMasks(MapData *map) {
+    PoseMaskTask tasks[POSE_MASK_COUNT];
+    Job jobs[POSE_MASK_COUNT];
+
+    for (int i = 0; i < POSE_MASK_COUNT; i++) {
+        tasks[i] = (PoseMaskTask){ map, (PoseMask)i };
+        InitJob(&jobs[i], "pose mask", buildPoseMask, &tasks[i]);
+        SubmitJob(&jobs[i]);
+    }
+    for (int i = 0; i < POSE_MASK_COUNT; i++) WaitForJob(&jobs[i]);
+}
+
+/*
+Job: extracts the road network from the distance field
+Parameter: Pointer to map's data (*arg) with its distance field already baked
+*/
+static void buildRoads(void *arg) {
+    MapData *map = arg;
+    map->roads = BuildRoadGraph(map->wallDistance, map->width, map->height);
+}
+
+/*
+Bakes the image of map's borders into packed bitsets (walls, restaurants, houses), so that border checks
+don't have to decode the image every time
+Parameter: Image of map with borders (borders)
+Returns: Map's data (MapData). Must be freed with UnloadMapData
+*/
+MapData LoadMapData(Image borders) {
+    MapData map = {0};
+    map.width = borders.width;
+    map.height = borders.height;
+    map.wordsPerRow = (borders.width + 63) / 64;
+
+    size_t words = (size_t)map.wordsPerRow * map.height;
+    map.wallBits = malloc(words * sizeof(uint64_t));
+    map.restaurantBits = malloc(words * sizeof(uint64_t));
+    map.houseBits = malloc(words * sizeof(uint64_t));
+
+    Color *pixels = LoadImageColors(borders);
+    ClassifyMapPixels(CLASSIFIER_BEST, pixels, map.width, map.height, map.wordsPerRow,
+                      (ClassifiedPixels){ map.wallBits, map.restaurantBits, map.houseBits });
+    UnloadImageColors(pixels);
+
+    map.wallDistance = malloc((size_t)map.width * map.height);
+    buildWallDistance(&map);
+
+    // The road network only needs the distance field, so it is extracted while the pose masks are built
+    Job roadsJob;
+    InitJob(&roadsJob, "road graph", buildRoads, &map);
+    SubmitJob(&roadsJob);
+    buildPoseMasks(&map);
+    WaitForJob(&roadsJob);
+    BuildSpawnTables(&map);
+    map.router = BuildRoadRouter(map.roads, ROUTER_LANDMARKS);
+    BuildRoadLanes(&map);
+
+    return map;
+}
+
+/*
+Frees map's data
+Parameter: Pointer to map's data (*map)
+*/
+void UnloadMapData(MapData *map) {
+    for (int i = 0; i < POSE_MASK_COUNT; i++) {
+        SpawnTable *table = &map->spawnTables[i];
+        free(table->words);
+        free(table->threshold);
+        free(table->alias);
+        *table = (SpawnTable){0};
+    }
+    free(map->lanes.pointStart);
+    free(map->lanes.turnStart);
+    for (int f = 0; f < LANE_FOOTPRINTS; f++) {
+        free(map->lanes.points[f]);
+        free(map->lanes.turnPoints[f]);
+        free(map->lanes.turns[f]);
+        free(map->lanes.open[f]);
+    }
+    map->lanes = (RoadLanes){0};
+    UnloadRoadTargets(&map->destinations);
+    UnloadRoadRouter(&map->router);
+    UnloadRoadGraph(&map->roads); // Frees nothing if it lives in the cache
+
+    if (map->cache.data != NULL) {
+        UnmapFile(&map->cache); // Nothing to free, the arrays live in the mapping
+    } else {
+        free(map->wallBits);
+        free(map->restaurantBits);
+        free(map->houseBits);
+        free(map->wallDistance);
+        for (int i = 0; i < POSE_MASK_COUNT; i++) free(map->poseBits[i]);
+    }
+
+    map->wallBits = NULL;
+    map->restaurantBits = NULL;
+    map->houseBits = NULL;
+    map->wallDistance = NULL;
+    for (int i = 0; i < POSE_MASK_COUNT; i++) map->poseBits[i] = NULL;
+}
+
+/*
+Checks every pixel of a rectangular area for walls, one 64-bit word at a time
+Parameters: Pointer to map's data (*map) and area's corners (x0, y0, x1, y1), inclusive
+Returns: true if the area lies inside the map and touches no wall. Otherwise, false
+*/
+bool IsAreaFree(const MapData *map, int x0, int y0, int x1, int y1) {
+    if (x0 < 0 || y0 < 0 || x1 >= map->width || y1 >= map->height) return false;
+
+    int firstWord = x0 >> 6;
+    int lastWord = x1 >> 6;
+    uint64_t firstMask = ~0ULL << (x0 & 63);
+    uint64_t lastMask = ~0ULL >> (63 - (x1 & 63));
+
+    for (int y = y0; y <= y1; y++) {
+        const uint64_t *bits = map->wallBits + (size_t)y * map->wordsPerRow;
+
+        if (firstWord == lastWord) {
+            if (bits[firstWord] & firstMask & lastMask) return false;
+            continue;
+        }
+        if (bits[firstWord] & firstMask) return false;
+        for (int i = firstWord + 1; i < lastWord; i++) {
+            if (bits[i]) return false;
+        }
+        if (bits[lastWord] & lastMask) return false;
+    }
+    return true;
+}
+
+/*
+Builds the alias table of one pose mask (Vose's method, in integers so that sampling stays exactly uniform)
+Parameters: Pointer to map's data (*map) and the pose mask (pose)
+*/
+static void buildSpawnTable(MapData *map, PoseMask pose) {
+    SpawnTable *table = &map->spawnTables[pose];
+    const uint64_t *bits = map->poseBits[pose];
+    size_t words = (size_t)map->wordsPerRow * map->height;
+
+    int count = 0;
+    int64_t total = 0;
+    for (size_t i = 0; i < words; i++) {
+        if (bits[i] == 0) continue;
+        count++;
+        total += __builtin_popcountll(bits[i]);
+    }
+
+    *table = (SpawnTable){0};
+    if (count == 0) return;
+    table->words = malloc(count * sizeof(uint32_t));
+    table->threshold = malloc(count * sizeof(uint32_t));
+    table->alias = malloc(count * sizeof(uint32_t));
+    table->count = count;
+    table->total = (int)total;
+
+    // Every word gets a bucket of size total. Word i needs popcount * count of them in total;
+    // a bucket that isn't filled by its own word is topped up by a "large" word (its alias)
+    int64_t *need = malloc(count * sizeof(int64_t));
+    int *small = malloc(count * sizeof(int));
+    int *large = malloc(count * sizeof(int));
+    int smallCount = 0, largeCount = 0;
+
+    for (size_t i = 0, k = 0; i < words; i++) {
+        if (bits[i] == 0) continue;
+        table->words[k] = (uint32_t)i;
+        need[k] = (int64_t)__builtin_popcountll(bits[i]) * count;
+        if (need[k] < total) small[smallCount++] = (int)k;
+        else large[largeCount++] = (int)k;
+        k++;
+    }
+
+    while (smallCount > 0 && largeCount > 0) {
+        int s = small[--smallCount];
+        int l = large[largeCount - 1];
+        table->threshold[s] = (uint32_t)need[s];
+        table->alias[s] = (uint32_t)l;
+        need[l] -= total - need[s];
+        if (need[l] < total) {
+            largeCount--;
+            small[smallCount++] = l;
+        }
+    }
+    // What's left fills its bucket on its own
+    while (largeCount > 0) {
+        int l = large[--largeCount];
+        table->threshold[l] = (uint32_t)total;
+        table->alias[l] = (uint32_t)l;
+    }
+    while (smallCount > 0) {
+        int s = small[--smallCount];
+        table->threshold[s] = (uint32_t)total;
+        table->alias[s] = (uint32_t)s;
+    }
+
+    free(large);
+    free(small);
+    free(need);
+}
+
+/*
+Builds the spawn tables of all pose masks. Called by LoadMapData and when loading the map cache
+Parameter: Pointer to map's data (*map) with its pose masks already baked
+*/
+void BuildSpawnTables(MapData *map) {
+    for (int i = 0; i < POSE_MASK_COUNT; i++) buildSpawnTable(map, (PoseMask)i);
+}
+
+/*
+Picks a valid center for a footprint uniformly at random among all of them, in constant time
+Parameters: Pointer to map's data (*map), footprint (pose) and pointer to the position to fill (*position)
+Returns: true if the footprint fits anywhere on the map. Otherwise, false
+*/
+bool GetRandomPosePosition(const MapData *map, PoseMask pose, Vector2 *position) {
+    const SpawnTable *table = &map->spawnTables[pose];
+    if (table->count == 0) return false;
+
+    int bucket = GetRandomValue(0, table->count - 1);
+    uint32_t word = table->words[bucket];
+    if ((uint32_t)GetRandomValue(0, table->total - 1) >= table->threshold[bucket]) word = table->words[table->alias[bucket]];
+
+    // A uniformly random set bit of the word
+    uint64_t bits = map->poseBits[pose][word];
+    int skip = GetRandomValue(0, __builtin_popcountll(bits) - 1);
+    for (int i = 0; i < skip; i++) bits &= bits - 1;
+
+    position->x = (float)((word % map->wordsPerRow) * 64 + __builtin_ctzll(bits));
+    position->y = (float)(word / map->wordsPerRow);
+    return true;
+}
+
+/*
+Checks if a footprint can drive in a straight line from one point to another without touching a wall. The line is walked
+one column (or row) of pixels at a time along its main axis, and every pixel it passes through, with a margin for rounding, is checked
+Parameters: Pointer to map's data (*map), footprint (pose) and the line's ends (from, to)
+Returns: true if the footprint fits at every point of the line. Otherwise, false
+*/
+bool IsLaneClear(const MapData *map, PoseMask pose, Vector2 from, Vector2 to) {
+    bool alongX = fabsf(to.x - from.x) >= fabsf(to.y - from.y);
+    float a0 = alongX ? from.x : from.y;
+    float b0 = alongX ? from.y : from.x;
+    float a1 = alongX ? to.x : to.y;
+    float b1 = alongX ? to.y : to.x;
+    if (a1 < a0) {
+        float temp = a0; a0 = a1; a1 = temp;
+        temp = b0; b0 = b1; b1 = temp;
+    }
+    float slope = (a1 > a0) ? (b1 - b0) / (a1 - a0) : 0.0f;
+
+    int last = (int)floorf(a1 + LANE_TOLERANCE);
+    for (int a = (int)floorf(a0 - LANE_TOLERANCE); a <= last; a++) {
+        // The part of the line inside this column (just an end, for the columns of the margin)
+        float low = fminf(fmaxf((float)a, a0), a1);
+        float high = fmaxf(fminf((float)a + 1, a1), a0);
+        float bLow = b0 + slope * (low - a0);
+        float bHigh = b0 + slope * (high - a0);
+        if (bLow > bHigh) {
+            float temp = bLow; bLow = bHigh; bHigh = temp;
+        }
+
+        int bLast = (int)floorf(bHigh + LANE_TOLERANCE);
+        for (int b = (int)floorf(bLow - LANE_TOLERANCE); b <= bLast; b++) {
+            if (!IsPoseValid(map, pose, (float)(alongX ? a : b), (float)(alongX ? b : a))) return false;
+        }
+    }
+    return true;
+}
+
+// A lane footprint to lay out the lanes of
+typedef struct {
+    MapData *map;
+    int footprint;
+} LaneTask;
+
+/*
+Finds the pose mask of a lane footprint driving along an axis
+Parameters: Lane footprint (footprint) and heading (heading)
+Returns: The pose mask (PoseMask)
+*/
+static PoseMask lanePose(int footprint, Vector2 heading) {
+    return (PoseMask)(2 * footprint + ((heading.x != 0) ? 1 : 0));
+}
+
+/*
+Moves a point to the right of a heading
+Parameters: The point (point), heading (heading) and distance, negative to the left (distance)
+Returns: The moved point (Vector2)
+*/
+static Vector2 shiftRight(Vector2 point, Vector2 heading, float distance) {
+    return (Vector2){ point.x - heading.y * distance, point.y + heading.x * distance };
+}
+
+/*
+Finds where two lines cross
+Parameters: A point and the direction of each line (a, aDirection, b, bDirection) and pointer to the crossing (*crossing)
+Returns: true if they cross. Otherwise (parallel), false
+*/
+static bool crossLines(Vector2 a, Vector2 aDirection, Vector2 b, Vector2 bDirection, Vector2 *crossing) {
+    float det = aDirection.x * bDirection.y - aDirection.y * bDirection.x;
+    if (fabsf(det) < 1e-3f * hypotf(aDirection.x, aDirection.y) * hypotf(bDirection.x, bDirection.y)) return false;
+    float t = ((b.x - a.x) * bDirection.y - (b.y - a.y) * bDirection.x) / det;
+    *crossing = (Vector2){ a.x + aDirection.x * t, a.y + aDirection.y * t };
+    return true;
+}
+
+/*
+Checks a leg of a lane: it must run forward along its axis, at most as much sideways as forward, and be clear of walls
+Parameters: Pointer to map's data (*map), lane footprint (footprint), the leg's axis (heading) and ends (from, to)
+Returns: true if it can be driven. Otherwise, false
+*/
+static bool isLegDrivable(const MapData *map, int footprint, Vector2 heading, Vector2 from, Vector2 to) {
+    float along = (to.x - from.x) * heading.x + (to.y - from.y) * heading.y;
+    float across = (to.x - from.x) * heading.y - (to.y - from.y) * heading.x;
+    if (along < -LANE_TOLERANCE || fabsf(across) > along + LANE_TOLERANCE) return false;
+    return IsLaneClear(map, lanePose(footprint, heading), from, to);
+}
+
+/*
+Lays out the lane of an edge at some distance from its centerline: every piece shifted sideways, with the bends where the shifted
+pieces meet. A piece that doubles back only has a lane on the centerline itself
+Parameters: Pointer to map's data (*map), lane footprint (footprint), edge (edge), distance right of the centerline, negative for left (offset)
+and the lane's points to fill (*lane), one per centerline point
+Returns: true if every leg can be driven. Otherwise, false
+*/
+static bool layLane(const MapData *map, int footprint, uint32_t edge, float offset, Vector2 *lane) {
+    const RoadGraph *graph = &map->roads;
+    uint32_t last = graph->segments[graph->edgeSegment[edge]].pointCount - 1;
+    Vector2 from = GetRoadEdgePoint(graph, edge, 0);
+    Vector2 to = GetRoadEdgePoint(graph, edge, 1);
+    Vector2 heading = GetRoadPieceHeading(from, to);
+    lane[0] = shiftRight(from, heading, offset);
+
+    for (uint32_t k = 1; k <= last; k++) {
+        Vector2 next = to;
+        Vector2 nextHeading = heading;
+        if (k == last) {
+            lane[k] = shiftRight(to, heading, offset);
+        } else {
+            next = GetRoadEdgePoint(graph, edge, k + 1);
+            nextHeading = GetRoadPieceHeading(to, next);
+            float turn = heading.x * nextHeading.x + heading.y * nextHeading.y;
+            if (turn > 0.5f) {
+                lane[k] = shiftRight(to, heading, offset); // Straight on: both shifted pieces pass through it
+            } else if (turn < -0.5f) {
+                if (offset != 0) return false;
+                lane[k] = to;
+            } else if (!crossLines(shiftRight(from, heading, offset), (Vector2){ to.x - from.x, to.y - from.y },
+                                   shiftRight(to, nextHeading, offset), (Vector2){ next.x - to.x, next.y - to.y }, &lane[k])) {
+                return false;
+            }
+        }
+        if (!isLegDrivable(map, footprint, heading, lane[k - 1], lane[k])) return false;
+
+        from = to;
+        to = next;
+        heading = nextHeading;
+    }
+    return true;
+}
+
+/*
+Lays out the turn from the lane of one edge onto the lane of the next. Across the road (90 degrees) the vehicle drives on to where
+the two lanes cross. The crossing may lie past the end of the first lane or before the start of the next one, and then that part is
+checked here. Otherwise, it must come after the start of the first lane's last leg and before the end of the next lane's first leg
+(their middles, for a lane with a single leg, so that whatever turn the vehicle came from, it never has to drive backwards).
+Straight on or back, the vehicle moves sideways at the node, from the end of one lane to the start of the other (if they differ)
+Parameters: Pointer to map's data (*map), lane footprint (footprint), the two edges (edge, next), their lanes (*lane, *nextLane)
+and pointer to where the first lane ends for this turn (*end)
+Returns: LaneTurnFlag of the turn (0 if it can't be driven)
+*/
+static uint8_t layTurn(const MapData *map, int footprint, uint32_t edge, uint32_t next, const Vector2 *lane, const Vector2 *nextLane, Vector2 *end) {
+    const RoadGraph *graph = &map->roads;
+    uint32_t last = graph->segments[graph->edgeSegment[edge]].pointCount - 1;
+    uint32_t nextLast = graph->segments[graph->edgeSegment[next]].pointCount - 1;
+    Vector2 before = GetRoadEdgePoint(graph, edge, last - 1);
+    Vector2 node = GetRoadEdgePoint(graph, edge, last);
+    Vector2 after = GetRoadEdgePoint(graph, next, 1);
+    Vector2 heading = GetRoadPieceHeading(before, node);
+    Vector2 nextHeading = GetRoadPieceHeading(node, after);
+    Vector2 laneEnd = lane[last];
+    Vector2 nextStart = nextLane[0];
+    *end = laneEnd;
+
+    if (fabsf(heading.x * nextHeading.x + heading.y * nextHeading.y) < 0.5f) {
+        Vector2 crossing;
+        if (!crossLines(laneEnd, (Vector2){ node.x - before.x, node.y - before.y },
+                        nextStart, (Vector2){ after.x - node.x, after.y - node.y }, &crossing)) return 0;
+        Vector2 legStart = (last > 1) ? lane[last - 1] : (Vector2){ (lane[0].x + laneEnd.x) / 2, (lane[0].y + laneEnd.y) / 2 };
+        Vector2 legEnd = (nextLast > 1) ? nextLane[1] : (Vector2){ (nextStart.x + nextLane[nextLast].x) / 2, (nextStart.y + nextLane[nextLast].y) / 2 };
+        if ((crossing.x - legStart.x) * heading.x + (crossing.y - legStart.y) * heading.y < -LANE_TOLERANCE ||
+            (legEnd.x - crossing.x) * nextHeading.x + (legEnd.y - crossing.y) * nextHeading.y < -LANE_TOLERANCE) return 0;
+
+        if ((crossing.x - laneEnd.x) * heading.x + (crossing.y - laneEnd.y) * heading.y > 0 &&
+            !IsLaneClear(map, lanePose(footprint, heading), laneEnd, crossing)) return 0;
+        if ((nextStart.x - crossing.x) * nextHeading.x + (nextStart.y - crossing.y) * nextHeading.y > 0 &&
+            !IsLaneClear(map, lanePose(footprint, nextHeading), crossing, nextStart)) return 0;
+        *end = crossing;
+        return LANE_TURN_OPEN;
+    }
+
+    if (hypotf(nextStart.x - laneEnd.x, nextStart.y - laneEnd.y) <= LANE_TOLERANCE) return LANE_TURN_OPEN;
+    if (!IsLaneClear(map, lanePose(footprint, GetRoadPieceHeading(laneEnd, nextStart)), laneEnd, nextStart)) return 0;
+    return LANE_TURN_OPEN | LANE_TURN_JOG;
+}
+
+/*
+Job: lays out the lanes of one footprint. Every edge gets its usual lane (one per direction if the road has room for two, else one
+on the centerline) or, if that one touches a wall, the nearest one up to LANE_MAX_SHIFT pixels to either side that doesn't. Edges
+with no lane are closed. Then every turn between two open edges is laid out, and edges with no open turn left are closed too, until
+none is, so that a vehicle never gets stuck at the end of an edge
+Parameter: Pointer to the task (*arg) with the map and the lane footprint to build
+*/
+static void buildLanes(void *arg) {
+    LaneTask *task = arg;
+    MapData *map = task->map;
+    RoadLanes *lanes = &map->lanes;
+    const RoadGraph *graph = &map->roads;
+    int footprint = task->footprint;
+    uint32_t edgeCount = (uint32_t)graph->segmentCount * 2;
+    float halfWidth = poseSizes[2 * footprint][0] / 2;
+
+    Vector2 *points = calloc((size_t)lanes->pointStart[edgeCount] + 1, sizeof(Vector2));
+    Vector2 *turnPoints = calloc((size_t)lanes->turnStart[edgeCount] + 1, sizeof(Vector2));
+    uint8_t *turns = calloc((size_t)lanes->turnStart[edgeCount] + 1, 1);
+    uint8_t *open = calloc((size_t)edgeCount + 1, 1);
+
+    // 1. Lanes: the usual one, then 1, -1, 2, -2, ... pixels further right
+    for (uint32_t e = 0; e < edgeCount; e++) {
+        const RoadSegment *segment = &graph->segments[graph->edgeSegment[e]];
+        float usual = (segment->width >= 2 * (2 * halfWidth + LANE_GAP)) ? halfWidth + LANE_GAP / 2 : 0.0f;
+        for (int shift = 0; shift <= 2 * LANE_MAX_SHIFT && !open[e]; shift++) {
+            float offset = usual + (float)((shift & 1) ? (shift + 1) / 2 : -(shift / 2));
+            open[e] = layLane(map, footprint, e, offset, points + lanes->pointStart[e]);
+        }
+    }
+
+    // 2. Turns between open edges
+    for (uint32_t e = 0; e < edgeCount; e++) {
+        if (!open[e]) continue;
+        uint32_t node = graph->edgeTarget[e];
+        for (uint32_t next = graph->edgeStart[node]; next < graph->edgeStart[node + 1]; next++) {
+            uint32_t turn = lanes->turnStart[e] + (next - graph->edgeStart[node]);
+            if (!open[next]) continue;
+            turns[turn] = layTurn(map, footprint, e, next, points + lanes->pointStart[e], points + lanes->pointStart[next], &turnPoints[turn]);
+        }
+    }
+
+    // 3. Edges that lead nowhere
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (uint32_t e = 0; e < edgeCount; e++) {
+            if (!open[e]) continue;
+            uint32_t first = graph->edgeStart[graph->edgeTarget[e]];
+            uint32_t last = graph->edgeStart[graph->edgeTarget[e] + 1];
+            bool leadsOn = false;
+            for (uint32_t next = first; next < last && !leadsOn; next++) {
+                leadsOn = (turns[lanes->turnStart[e] + (next - first)] & LANE_TURN_OPEN) && open[next];
+            }
+            if (!leadsOn) {
+                open[e] = 0;
+                changed = true;
+            }
+        }
+    }
+    for (uint32_t e = 0; e < edgeCount; e++) {
+        uint32_t first = graph->edgeStart[graph->edgeTarget[e]];
+        for (uint32_t next = first; next < graph->edgeStart[graph->edgeTarget[e] + 1]; next++) {
+            if (!open[e] || !open[next]) turns[lanes->turnStart[e] + (next - first)] &= (uint8_t)~LANE_TURN_OPEN;
+        }
+    }
+
+    lanes->points[footprint] = points;
+    lanes->turnPoints[footprint] = turnPoints;
+    lanes->turns[footprint] = turns;
+    lanes->open[footprint] = open;
+}
+
+/*
+Lays out the lanes of the road network for every lane footprint, as parallel jobs. Called by LoadMapData and when loading the map cache
+Parameter: Pointer to map's data (*map) with its pose masks and road network already built
+*/
+void BuildRoadLanes(MapData *map) {
+    const RoadGraph *graph = &map->roads;
+    RoadLanes *lanes = &map->lanes;
+    uint32_t edgeCount = (uint32_t)graph->segmentCount * 2;
+
+    lanes->pointStart = malloc(((size_t)edgeCount + 1) * sizeof(uint32_t));
+    lanes->turnStart = malloc(((size_t)edgeCount + 1) * sizeof(uint32_t));
+    lanes->pointStart[0] = 0;
+    lanes->turnStart[0] = 0;
+    for (uint32_t e = 0; e < edgeCount; e++) {
+        uint32_t node = graph->edgeTarget[e];
+        lanes->pointStart[e + 1] = lanes->pointStart[e] + graph->segments[graph->edgeSegment[e]].pointCount;
+        lanes->turnStart[e + 1] = lanes->turnStart[e] + (graph->edgeStart[node + 1] - graph->edgeStart[node]);
+    }
+
+    LaneTask tasks[LANE_FOOTPRINTS];
+    Job jobs[LANE_FOOTPRINTS];
+    for (int f = 0; f < LANE_FOOTPRINTS; f++) {
+        tasks[f] = (LaneTask){ map, f };
+        InitJob(&jobs[f], "road lanes", buildLanes, &tasks[f]);
+        SubmitJob(&jobs[f]);
+    }
+    for (int f = 0; f < LANE_FOOTPRINTS; f++) WaitForJob(&jobs[f]);
+}
@@ -0,0 +1,114 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+#ifndef MAPDATA_H
+#define MAPDATA_H
+
+#include <stdint.h>
+#include "raylib.h"
+#include "platform.h"
+#include "roadGraph.h"
+#include "roadRouter.h"
+
+// Vehicle footprints (car/police 8x13, truck 11x22) in both orientations.
+// Rotations 0/180 and 90/270 cover the same pixels, so they share a mask
+typedef enum { POSE_CAR_VERTICAL, POSE_CAR_HORIZONTAL, POSE_TRUCK_VERTICAL, POSE_TRUCK_HORIZONTAL, POSE_MASK_COUNT } PoseMask;
+
+// Alias table over the words of a pose mask, weighted by their set bits, so that a valid
+// center can be drawn uniformly in O(1): pick a word, then one of its set bits
+typedef struct {
+    uint32_t *words;     // Index of every word with at least one set bit
+    uint32_t *threshold; // Keep words[i] if a random value in [0, total) is below threshold[i], else take alias[i]
+    uint32_t *alias;
+    int count;           // Number of words in the table
+    int total;           // Number of set bits (valid centers) in the mask
+} SpawnTable;
+
+#define LANE_FOOTPRINTS 2 // Footprints with lanes of their own: cars (police cars too) and trucks
+
+// Flags of a turn from one lane onto the next
+typedef enum { LANE_TURN_OPEN = 1, LANE_TURN_JOG = 2 } LaneTurnFlag; // It can be driven / it ends with a sideways move into the next lane
+
+// The lanes vehicles drive along on the road network, laid out per footprint and checked against its pose masks,
+// so that a vehicle that follows them never touches a wall. The lane of an edge has a point per centerline point,
+// where it starts, bends and ends. Every leg in between runs along an axis, drifting sideways on a slanted piece.
+// The last leg ends where the vehicle turns, which depends on the next edge
+typedef struct {
+    uint32_t *pointStart; // The lane of edge e is points[f][pointStart[e]] .. points[f][pointStart[e + 1] - 1]
+    uint32_t *turnStart;  // The turn from edge e onto the j-th edge leaving its target node is turn turnStart[e] + j
+    Vector2 *points[LANE_FOOTPRINTS];
+    Vector2 *turnPoints[LANE_FOOTPRINTS]; // Where the last leg ends, for every turn
+    uint8_t *turns[LANE_FOOTPRINTS];      // LaneTurnFlag of every turn
+    uint8_t *open[LANE_FOOTPRINTS];       // Per edge, true if its lane can be driven and leads on to an open turn
+} RoadLanes;
+
+// Everything we derive from mapWithBorders.png once at load time
+typedef struct {
+    int width;
+    int height;
+    int wordsPerRow;    // 64-bit words per bitset row (rows are word aligned)
+    uint64_t *wallBits; // 1 bit per pixel, set if the pixel is a wall ("too red")
+    uint64_t *restaurantBits; // Same layout, green pixels (read by InitMapLocations)
+    uint64_t *houseBits;      // Same layout, blue pixels (read by InitMapLocations)
+    uint8_t *wallDistance; // Distance (pixels, rounded down, max 255) to the nearest wall or the map's edge
+    uint64_t *poseBits[POSE_MASK_COUNT]; // Same layout as wallBits, set if a footprint centered on the pixel is clear
+    SpawnTable spawnTables[POSE_MASK_COUNT]; // Built from poseBits at load, never cached
+    RoadGraph roads;    // Road network, extracted from wallDistance
+    RoadRouter router;  // Path queries over roads, built at load, never cached
+    RoadLanes lanes;    // Built from poseBits and roads at load, never cached
+    RoadTargets destinations; // Restaurants and houses traffic heads for (see InitTrafficDestinations), never cached
+    MappedFile cache; // When loaded from a map cache, the arrays above point into this read-only mapping
+} MapData;
+
+// functions
+MapData LoadMapData(Image borders);
+void UnloadMapData(MapData *map);
+bool IsAreaFree(const MapData *map, int x0, int y0, int x1, int y1);
+void BuildSpawnTables(MapData *map);
+bool GetRandomPosePosition(const MapData *map, PoseMask pose, Vector2 *position);
+bool IsLaneClear(const MapData *map, PoseMask pose, Vector2 from, Vector2 to);
+void BuildRoadLanes(MapData *map);
+
+/*
+Checks if a pixel of the map is a wall. Pixels outside of the map count as walls
+Parameters: Pointer to map's data (*map) and pixel's coordinates (x, y)
+Returns: true if wall. Otherwise, false
+*/
+static inline bool IsWallPixel(const MapData *map, int x, int y) {
+    if ((unsigned)x >= (unsigned)map->width || (unsigned)y >= (unsigned)map->height) return true;
+    return (map->wallBits[(size_t)y * map->wordsPerRow + (x >> 6)] >> (x & 63)) & 1;
+}
+
+/*
+Finds the clearance around a pixel of the map
+Parameters: Pointer to map's data (*map) and pixel's coordinates (x, y)
+Returns: Distance to the nearest wall, rounded down (0 for walls and off-map pixels)
+*/
+static inline int GetWallDistance(const MapData *map, int x, int y) {
+    if ((unsigned)x >= (unsigned)map->width || (unsigned)y >= (unsigned)map->height) return 0;
+    return map->wallDistance[(size_t)y * map->width + x];
+}
+
+/*
+Checks if a vehicle footprint centered at a position fits on the road
+Parameters: Pointer to map's data (*map), footprint (pose) and position's coordinates (px, py)
+Returns: true if the footprint touches no wall. Otherwise, false
+*/
+static inline bool IsPoseValid(const MapData *map, PoseMask pose, float px, float py) {
+    if (px < 0 || py < 0) return false;
+    int x = (int)px;
+    int y = (int)py;
+    if (x >= map->width || y >= map->height) return false;
+    return (map->poseBits[pose][(size_t)y * map->wordsPerRow + (x >> 6)] >> (x & 63)) & 1;
+}
+
+#endif
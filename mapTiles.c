@@ -0,0 +1,209 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include "raylib.h"
+#include "mapTiles.h"
+
+// --- TILE STREAMING CONSTANTS ---
+const int TILE_PREFETCH_PER_FRAME = 1; // Tiles around the view uploaded ahead of time, per frame
+
+/*
+Splits an image into tiles. Only touches CPU memory, so it can run on a worker thread
+Parameters: Whole background's image (image) and tiles' side in pixels (tileSize)
+Returns: The tiles (MapTiles). Must be freed with UnloadMapTiles
+*/
+MapTiles LoadMapTiles(Image image, int tileSize) {
+    MapTiles tiles = {0};
+    tiles.width = image.width;
+    tiles.height = image.height;
+    tiles.tileSize = tileSize;
+    tiles.columns = (image.width + tileSize - 1) / tileSize;
+    tiles.rows = (image.height + tileSize - 1) / tileSize;
+    tiles.tiles = calloc((size_t)tiles.columns * tiles.rows, sizeof(MapTile));
+
+    for (int row = 0; row < tiles.rows; row++) {
+        for (int column = 0; column < tiles.columns; column++) {
+            MapTile *tile = &tiles.tiles[row * tiles.columns + column];
+            int x = column * tileSize;
+            int y = row * tileSize;
+            tile->width = (image.width - x < tileSize) ? image.width - x : tileSize;
+            tile->height = (image.height - y < tileSize) ? image.height - y : tileSize;
+            tile->slot = -1;
+            tile->image = ImageFromImage(image, (Rectangle){ x, y, tile->width, tile->height });
+            if (tile->width < tileSize || tile->height < tileSize) ImageResizeCanvas(&tile->image, tileSize, tileSize, 0, 0, BLACK);
+        }
+    }
+    return tiles;
+}
+
+/*
+Frees the tiles and their cached textures
+Parameter: Pointer to the tiles (*tiles)
+*/
+void UnloadMapTiles(MapTiles *tiles) {
+    for (int i = 0; i < tiles->slotCount; i++) UnloadTexture(tiles->slots[i].texture);
+    for (int i = 0; i < tiles->columns * tiles->rows; i++) UnloadImage(tiles->tiles[i].image);
+    free(tiles->tiles);
+    *tiles = (MapTiles){0};
+}
+
+/*
+Finds a texture for a tile: a free one, a new one (up to MAX_TILE_TEXTURES) or the least recently used one.
+Tiles drawn after the given frame are never evicted, since their draw calls may still be batched
+Parameters: Pointer to the tiles (*tiles) and last frame whose tiles may be evicted (evictBefore)
+Returns: Index of the slot (-1 if every slot is in use)
+*/
+static int acquireSlot(MapTiles *tiles, unsigned evictBefore) {
+    for (int i = 0; i < tiles->slotCount; i++) {
+        if (tiles->slots[i].tile < 0) return i;
+    }
+
+    if (tiles->slotCount < MAX_TILE_TEXTURES) {
+        // Every slot has the format of the tiles, so any tile can be uploaded into any slot
+        const MapTile *first = &tiles->tiles[0];
+        TileSlot *slot = &tiles->slots[tiles->slotCount];
+        slot->texture = LoadTextureFromImage(first->image);
+        SetTextureFilter(slot->texture, TEXTURE_FILTER_POINT);
+        slot->tile = -1;
+        slot->lastUsed = 0;
+        return tiles->slotCount++;
+    }
+
+    int oldest = -1;
+    for (int i = 0; i < tiles->slotCount; i++) {
+        if (tiles->slots[i].lastUsed >= evictBefore) continue;
+        if (oldest < 0 || tiles->slots[i].lastUsed < tiles->slots[oldest].lastUsed) oldest = i;
+    }
+    if (oldest >= 0) {
+        tiles->tiles[tiles->slots[oldest].tile].slot = -1;
+        tiles->slots[oldest].tile = -1;
+    }
+    return oldest;
+}
+
+/*
+Makes sure a tile is on the GPU, uploading it if needed
+Parameters: Pointer to the tiles (*tiles), tile's index (index) and last frame whose tiles may be evicted (evictBefore)
+Returns: Index of the slot that holds the tile (-1 if there was no room)
+*/
+static int makeResident(MapTiles *tiles, int index, unsigned evictBefore) {
+    MapTile *tile = &tiles->tiles[index];
+    if (tile->slot >= 0) return tile->slot;
+
+    int slot = acquireSlot(tiles, evictBefore);
+    if (slot < 0) return -1;
+
+    UpdateTexture(tiles->slots[slot].texture, tile->image.data);
+    tiles->slots[slot].tile = index;
+    tiles->slots[slot].lastUsed = 0;
+    tile->slot = slot;
+    return slot;
+}
+
+/*
+Finds the range of tiles that intersects a rectangle of the map
+Parameters: Pointer to the tiles (*tiles), the rectangle (area) and pointers to the range (*x0, *y0, *x1, *y1), inclusive
+Returns: true if any tile intersects it. Otherwise, false
+*/
+static bool tileRange(const MapTiles *tiles, Rectangle area, int *x0, int *y0, int *x1, int *y1) {
+    *x0 = (int)floorf(area.x / tiles->tileSize);
+    *y0 = (int)floorf(area.y / tiles->tileSize);
+    *x1 = (int)floorf((area.x + area.width) / tiles->tileSize);
+    *y1 = (int)floorf((area.y + area.height) / tiles->tileSize);
+    if (*x0 < 0) *x0 = 0;
+    if (*y0 < 0) *y0 = 0;
+    if (*x1 >= tiles->columns) *x1 = tiles->columns - 1;
+    if (*y1 >= tiles->rows) *y1 = tiles->rows - 1;
+    return *x0 <= *x1 && *y0 <= *y1;
+}
+
+/*
+Starts a new frame: uploads a few of the tiles around last frame's views ahead of time,
+so that moving across a tile's edge doesn't stall on uploads. Call once per frame, before drawing
+Parameter: Pointer to the tiles (*tiles)
+*/
+void UpdateMapTiles(MapTiles *tiles) {
+    tiles->frame++;
+    tiles->prefetchArea = tiles->drawnArea;
+    tiles->drawnArea = (Rectangle){0};
+    if (tiles->prefetchArea.width <= 0 || tiles->prefetchArea.height <= 0) return;
+
+    Rectangle area = tiles->prefetchArea;
+    area.x -= tiles->tileSize;
+    area.y -= tiles->tileSize;
+    area.width += 2 * tiles->tileSize;
+    area.height += 2 * tiles->tileSize;
+
+    int x0, y0, x1, y1;
+    if (!tileRange(tiles, area, &x0, &y0, &x1, &y1)) return;
+
+    int uploads = 0;
+    for (int y = y0; y <= y1 && uploads < TILE_PREFETCH_PER_FRAME; y++) {
+        for (int x = x0; x <= x1 && uploads < TILE_PREFETCH_PER_FRAME; x++) {
+            int index = y * tiles->columns + x;
+            if (tiles->tiles[index].slot >= 0) continue;
+            // Only evict tiles that weren't visible last frame either
+            int slot = makeResident(tiles, index, tiles->frame - 1);
+            if (slot < 0) return;
+            tiles->slots[slot].lastUsed = tiles->frame; // Counts as used, or the next prefetch would evict it
+            uploads++;
+        }
+    }
+}
+
+/*
+Draws the tiles that intersect a view of the map, uploading the missing ones
+Parameters: Pointer to the tiles (*tiles), visible rectangle in map's coordinates (view),
+where to draw the map's top left corner (offset) and color tint (tint)
+*/
+void DrawMapTiles(MapTiles *tiles, Rectangle view, Vector2 offset, Color tint) {
+    int x0, y0, x1, y1;
+    if (!tileRange(tiles, view, &x0, &y0, &x1, &y1)) return;
+
+    if (tiles->drawnArea.width <= 0) {
+        tiles->drawnArea = view;
+    } else {
+        float right = fmaxf(tiles->drawnArea.x + tiles->drawnArea.width, view.x + view.width);
+        float bottom = fmaxf(tiles->drawnArea.y + tiles->drawnArea.height, view.y + view.height);
+        tiles->drawnArea.x = fminf(tiles->drawnArea.x, view.x);
+        tiles->drawnArea.y = fminf(tiles->drawnArea.y, view.y);
+        tiles->drawnArea.width = right - tiles->drawnArea.x;
+        tiles->drawnArea.height = bottom - tiles->drawnArea.y;
+    }
+
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            int index = y * tiles->columns + x;
+            int slot = makeResident(tiles, index, tiles->frame);
+            if (slot < 0) continue; // More tiles on screen than textures, can't happen at the game's zoom levels
+
+            const MapTile *tile = &tiles->tiles[index];
+            tiles->slots[slot].lastUsed = tiles->frame;
+            Rectangle source = { 0, 0, tile->width, tile->height };
+            Vector2 position = { offset.x + x * tiles->tileSize, offset.y + y * tiles->tileSize };
+            DrawTextureRec(tiles->slots[slot].texture, source, position, tint);
+        }
+    }
+}
+
+/*
+Finds which part of the world a camera shows in an area of the screen
+Parameters: The camera (camera) and the area of the screen (screenArea)
+Returns: Visible rectangle in world coordinates (Rectangle)
+*/
+Rectangle GetCameraView(Camera2D camera, Rectangle screenArea) {
+    Vector2 topLeft = GetScreenToWorld2D((Vector2){ screenArea.x, screenArea.y }, camera);
+    Vector2 bottomRight = GetScreenToWorld2D((Vector2){ screenArea.x + screenArea.width, screenArea.y + screenArea.height }, camera);
+    return (Rectangle){ topLeft.x, topLeft.y, bottomRight.x - topLeft.x, bottomRight.y - topLeft.y };
+}
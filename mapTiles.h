@@ -0,0 +1,58 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+#ifndef MAPTILES_H
+#define MAPTILES_H
+
+#include "raylib.h"
+
+#define MAP_TILE_SIZE 512
+#define MAX_TILE_TEXTURES 48 // Upper bound of VRAM used by the background (48 tiles of 512x512)
+
+// A square piece of the background. The CPU copy always exists, the GPU copy only while cached
+typedef struct {
+    Image image;  // Padded to the full tile size, so that every tile fits in any cached texture
+    int width;    // Real size (smaller on the right and bottom edges)
+    int height;
+    int slot;     // Cached texture that holds the tile, -1 if none
+} MapTile;
+
+// A cached texture and the tile it currently holds
+typedef struct {
+    Texture2D texture;
+    int tile;          // -1 if free
+    unsigned lastUsed; // Frame it was last drawn in (for LRU eviction)
+} TileSlot;
+
+// Background split into tiles, streamed to the GPU through an LRU cache of textures
+typedef struct {
+    int width;   // Whole map, in pixels
+    int height;
+    int tileSize;
+    int columns;
+    int rows;
+    MapTile *tiles;
+    TileSlot slots[MAX_TILE_TEXTURES];
+    int slotCount;
+    unsigned frame;
+    Rectangle drawnArea;   // Union of the views drawn during the current frame
+    Rectangle prefetchArea; // Same, for the previous frame
+} MapTiles;
+
+// functions
+MapTiles LoadMapTiles(Image image, int tileSize);
+void UnloadMapTiles(MapTiles *tiles);
+void UpdateMapTiles(MapTiles *tiles);
+void DrawMapTiles(MapTiles *tiles, Rectangle view, Vector2 offset, Color tint);
+Rectangle GetCameraView(Camera2D camera, Rectangle screenArea);
+
+#endif
@@ -0,0 +1,155 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+#include <math.h>
+#include "raylib.h"
+#include "minimap.h"
+
+// --- MINIMAP CONSTANTS ---
+const int MINIMAP_OVERLAY_MARGIN = 16;   // Extra pixels around the overlay, so that it still covers the minimap while the player moves
+const float MINIMAP_VEHICLE_RADIUS = 2.0f;
+const float MINIMAP_TARGET_SIZE = 20.0f; // Pickup/dropoff square's side, in map pixels
+const int MINIMAP_ROUTE_STRIDE = 4;      // Cells of the flow field between the route's points
+const float MINIMAP_ROUTE_WIDTH = 2.0f;
+#define MINIMAP_ROUTE_POINTS 256
+
+/*
+Downsamples the map's picture to the minimap's zoom (or less, for very large maps). Only touches CPU memory
+Parameters: Map's picture (background) and minimap's zoom (zoom)
+Returns: Downsampled image (Image)
+*/
+Image BakeMinimapImage(Image background, float zoom) {
+    int largest = (background.width > background.height) ? background.width : background.height;
+    float scale = zoom;
+    if (largest * scale > MINIMAP_MAX_BASE_SIZE) scale = (float)MINIMAP_MAX_BASE_SIZE / largest;
+
+    Image base = ImageCopy(background);
+    ImageResize(&base, (int)ceilf(background.width * scale), (int)ceilf(background.height * scale));
+    return base;
+}
+
+/*
+Uploads the minimap's base and creates its overlay. Must run on the main thread
+Parameters: Downsampled map (baseImage), map's width in pixels (mapWidth), minimap's size on screen (width, height),
+zoom (zoom) and overlay redraws per second (updateRate)
+Returns: The minimap (Minimap). Must be freed with UnloadMinimap
+*/
+Minimap LoadMinimap(Image baseImage, int mapWidth, int width, int height, float zoom, float updateRate) {
+    Minimap minimap = {0};
+    minimap.width = width;
+    minimap.height = height;
+    minimap.zoom = zoom;
+    minimap.base = LoadTextureFromImage(baseImage);
+    minimap.baseScale = (float)baseImage.width / mapWidth;
+    SetTextureFilter(minimap.base, TEXTURE_FILTER_BILINEAR);
+
+    minimap.overlay = LoadRenderTexture(width + 2 * MINIMAP_OVERLAY_MARGIN, height + 2 * MINIMAP_OVERLAY_MARGIN);
+    minimap.updateInterval = (updateRate > 0) ? 1.0f / updateRate : 0.0f;
+    minimap.timer = 0.0f; // Draw the overlay on the first update
+    return minimap;
+}
+
+/*
+Frees minimap's textures
+Parameter: Pointer to the minimap (*minimap)
+*/
+void UnloadMinimap(Minimap *minimap) {
+    UnloadTexture(minimap->base);
+    UnloadRenderTexture(minimap->overlay);
+}
+
+/*
+Redraws the overlay's markers (vehicles as dots, route to the target, pickup/dropoff square) when it's due
+Parameters: Pointer to the minimap (*minimap), time since last frame (deltaTime), map position at the minimap's center (center),
+pointer to the vehicle store (*vehicles), pointer to the current order (*order) and the way to its target (*route, NULL for none)
+*/
+void UpdateMinimapOverlay(Minimap *minimap, float deltaTime, Vector2 center, const VehicleStore *vehicles, const Order *order, const FlowField *route) {
+    minimap->timer -= deltaTime;
+    if (minimap->timer > 0) return;
+    minimap->timer += minimap->updateInterval;
+    if (minimap->timer < 0) minimap->timer = 0; // Don't try to catch up after a long frame
+
+    minimap->overlayCenter = center;
+    Vector2 middle = { minimap->overlay.texture.width / 2.0f, minimap->overlay.texture.height / 2.0f };
+
+    BeginTextureMode(minimap->overlay);
+        ClearBackground(BLANK);
+
+        // Only the vehicles under the overlay (dots may stick out by their radius), through the grid
+        float halfWidth = (middle.x + MINIMAP_VEHICLE_RADIUS) / minimap->zoom;
+        float halfHeight = (middle.y + MINIMAP_VEHICLE_RADIUS) / minimap->zoom;
+        VehicleQuery query = BeginVehicleQuery(vehicles, (Rectangle){ center.x - halfWidth, center.y - halfHeight, 2 * halfWidth, 2 * halfHeight });
+        for (int i = NextVehicle(vehicles, &query); i >= 0; i = NextVehicle(vehicles, &query)) {
+            Vector2 dot = { middle.x + (vehicles->x[i] - center.x) * minimap->zoom, middle.y + (vehicles->y[i] - center.y) * minimap->zoom };
+            DrawCircleV(dot, MINIMAP_VEHICLE_RADIUS, vehicles->color[i]);
+        }
+
+        if (order->isActive) {
+            // Restaurant before pickup, house after
+            Vector2 target = order->foodPickedUp ? order->dropoffLocation : order->pickupLocation;
+
+            Vector2 points[MINIMAP_ROUTE_POINTS];
+            int count = (route != NULL && route->target.x == target.x && route->target.y == target.y) ?
+                        GetFlowRoute(route, center, MINIMAP_ROUTE_STRIDE, points, MINIMAP_ROUTE_POINTS) : 0;
+            for (int i = 0; i < count; i++) {
+                points[i] = (Vector2){ middle.x + (points[i].x - center.x) * minimap->zoom, middle.y + (points[i].y - center.y) * minimap->zoom };
+                if (i > 0) DrawLineEx(points[i - 1], points[i], MINIMAP_ROUTE_WIDTH, Fade(YELLOW, 0.8f));
+            }
+
+            float side = MINIMAP_TARGET_SIZE * minimap->zoom;
+            DrawRectangleV((Vector2){ middle.x + (target.x - center.x) * minimap->zoom - side / 2, middle.y + (target.y - center.y) * minimap->zoom - side / 2 },
+                           (Vector2){ side, side }, YELLOW);
+        }
+    EndTextureMode();
+}
+
+/*
+Draws the minimap's base and overlay. The player's marker is left to the caller, since it must follow the player every frame
+Parameters: Pointer to the minimap (*minimap), minimap's top left corner on screen (x, y),
+map position at the minimap's center (center) and tint of the base (tint)
+*/
+void DrawMinimap(const Minimap *minimap, int x, int y, Vector2 center, Color tint) {
+    // Part of the base under the minimap, clipped to the map so that the texture doesn't repeat
+    float s = minimap->baseScale;
+    float pixelsPerBase = minimap->zoom / s; // Screen pixels per base pixel
+    Rectangle source = {
+        (center.x - minimap->width / 2.0f / minimap->zoom) * s,
+        (center.y - minimap->height / 2.0f / minimap->zoom) * s,
+        minimap->width / pixelsPerBase,
+        minimap->height / pixelsPerBase
+    };
+    float left = fmaxf(source.x, 0);
+    float top = fmaxf(source.y, 0);
+    float right = fminf(source.x + source.width, minimap->base.width);
+    float bottom = fminf(source.y + source.height, minimap->base.height);
+
+    if (right > left && bottom > top) {
+        Rectangle clipped = { left, top, right - left, bottom - top };
+        Rectangle dest = {
+            x + (left - source.x) * pixelsPerBase,
+            y + (top - source.y) * pixelsPerBase,
+            clipped.width * pixelsPerBase,
+            clipped.height * pixelsPerBase
+        };
+        DrawTexturePro(minimap->base, clipped, dest, (Vector2){ 0, 0 }, 0.0f, tint);
+    }
+
+    // The overlay was drawn around an older position, shift it by how much the center moved since then
+    Vector2 position = {
+        x - MINIMAP_OVERLAY_MARGIN + (minimap->overlayCenter.x - center.x) * minimap->zoom,
+        y - MINIMAP_OVERLAY_MARGIN + (minimap->overlayCenter.y - center.y) * minimap->zoom
+    };
+    Rectangle flipped = { 0, 0, minimap->overlay.texture.width, -minimap->overlay.texture.height }; // Render textures are upside down
+    BeginScissorMode(x, y, minimap->width, minimap->height);
+        DrawTextureRec(minimap->overlay.texture, flipped, position, WHITE);
+    EndScissorMode();
+}
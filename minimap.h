@@ -0,0 +1,49 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+#include "raylib.h"
+#include "helpers.h"
+#include "flowField.h"
+
+#define MINIMAP_MAX_BASE_SIZE 2048 // Largest side of the downsampled map, whatever the map's size
+
+// Minimap's layout (defined in main.c)
+extern const int MINIMAP_WIDTH;
+extern const int MINIMAP_HEIGHT;
+extern const float MINIMAP_ZOOM;
+extern const float MINIMAP_UPDATE_RATE;
+
+// The minimap: a static base (the whole map, downsampled once) and an overlay with the dynamic
+// markers, redrawn a few times per second around the position the player had at the time
+typedef struct {
+    int width;   // On screen, in pixels
+    int height;
+    float zoom;  // Screen pixels per map pixel
+    Texture2D base;
+    float baseScale; // Base texture's pixels per map pixel
+    RenderTexture2D overlay;
+    Vector2 overlayCenter; // Map position at the overlay's center, when it was last redrawn
+    float updateInterval;  // Seconds between overlay redraws
+    float timer;           // Seconds until the next redraw
+} Minimap;
+
+// functions
+Image BakeMinimapImage(Image background, float zoom);
+Minimap LoadMinimap(Image baseImage, int mapWidth, int width, int height, float zoom, float updateRate);
+void UnloadMinimap(Minimap *minimap);
+void UpdateMinimapOverlay(Minimap *minimap, float deltaTime, Vector2 center, const VehicleStore *vehicles, const Order *order, const FlowField *route);
+void DrawMinimap(const Minimap *minimap, int x, int y, Vector2 center, Color tint);
+
+#endif
@@ -0,0 +1,33 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+// OS specific code lives in platform.c, which must not include raylib.h (it clashes with windows.h)
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// A read-only file mapped into memory
+typedef struct {
+    const void *data;
+    size_t size;
+} MappedFile;
+
+// functions
+bool MapFileReadOnly(const char *path, MappedFile *file);
+void UnmapFile(MappedFile *file);
+double GetPreciseTime(void);
+int GetProcessorCount(void);
+
+#endif
@@ -0,0 +1,394 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include "raylib.h"
+#include "profiler.h"
+#include "jobs.h"
+
+#define TRACE_BLOCK_EVENTS 16384 // Events per block handed to the writer thread
+#define TRACE_BLOCKS 4           // Blocks in flight: one being filled, the rest waiting to be written
+
+// --- PROFILER CONSTANTS ---
+static const char *ZONE_NAMES[PROFILE_ZONE_COUNT] = {
+    "Frame", "Music", "Tile streaming", "Simulation", "  Traffic", "  Orders", "  Movement",
+    "Camera", "World draw", "Minimap draw", "HUD", "Present"
+};
+static const float FRAME_BUDGET = 1000.0f / 60.0f; // Milliseconds, the line drawn across the graph
+static const int PANEL_WIDTH = 330;
+static const int ROW_HEIGHT = 14;
+static const int GRAPH_HEIGHT = 70;
+static const size_t TRACE_FILE_BUFFER = 1 << 20; // stdio buffer of the trace file
+
+// One finished zone or job, as a Chrome trace "complete" event
+typedef struct {
+    const char *name; // Static string: a zone's or a job's name
+    const char *category;
+    int thread;       // 0 for the main thread, 1.. for job workers
+    double start;     // GetPreciseTime() at both ends
+    double end;
+} TraceEvent;
+
+typedef struct {
+    TraceEvent events[TRACE_BLOCK_EVENTS];
+    atomic_int count;   // May run past TRACE_BLOCK_EVENTS, the extra events are dropped
+    atomic_int writers; // Threads that may still store an event, the writer waits for them before reading the block
+} TraceBlock;
+
+// A capture: the main thread and the job workers fill a block during some frames, at the end of a frame it goes to the
+// writer thread, which formats and saves it while the game keeps playing. Jobs may still be running then (e.g. a flow field
+// spans frames), so every event is stored under the block's writers count
+typedef struct {
+    FILE *file;
+    char path[64];
+    double start;
+    double end;
+    TraceBlock *blocks;                // TRACE_BLOCKS of them, used in a ring
+    _Atomic(TraceBlock *) currentBlock; // NULL while every block waits for the writer, events are dropped then
+    atomic_int dropped;
+    atomic_int pushing;                // Threads inside pushTraceEvent, the blocks are freed only when none is
+    int submitted;                     // Blocks handed to the writer
+    int written;                       // Blocks the writer has saved
+    bool stopping;
+    long long eventsWritten;
+    pthread_t writer;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} TraceCapture;
+
+bool profilerEnabled = false;
+bool profilerRecording = false;
+double profileZoneStart[PROFILE_ZONE_COUNT];
+static double profileZoneTime[PROFILE_ZONE_COUNT];
+
+// Ring buffer of the last frames, in milliseconds
+static float history[PROFILER_FRAMES][PROFILE_ZONE_COUNT];
+static int historyNext = 0;  // Row the next frame goes to
+static int historyCount = 0; // Rows filled since the profiler was enabled
+static double frameStart = 0;
+
+static TraceCapture capture;
+static bool capturing = false;
+
+/*
+Starts recording zones if the overlay or a capture needs them, with a fresh frame
+*/
+static void updateRecording(void) {
+    bool recording = profilerEnabled || capturing;
+    if (recording && !profilerRecording) {
+        memset(profileZoneTime, 0, sizeof(profileZoneTime));
+        frameStart = GetPreciseTime();
+    }
+    profilerRecording = recording;
+}
+
+/*
+Turns the overlay on or off. Turning it on starts a fresh history
+Parameter: true to show it (enabled)
+*/
+void SetProfilerEnabled(bool enabled) {
+    if (enabled && !profilerEnabled) {
+        historyNext = 0;
+        historyCount = 0;
+    }
+    profilerEnabled = enabled;
+    updateRecording();
+}
+
+/*
+Adds an event to the block being filled. Safe to call from any thread
+Parameters: Event's name (*name), category (*category), thread (thread) and its start and end times (start, end)
+*/
+static void pushTraceEvent(const char *name, const char *category, int thread, double start, double end) {
+    atomic_fetch_add(&capture.pushing, 1); // Before reading currentBlock, see StopProfilerCapture
+    TraceBlock *block = atomic_load(&capture.currentBlock);
+    int index = TRACE_BLOCK_EVENTS;
+    if (block != NULL) {
+        // If the block is still current after we joined its writers, the writer thread will wait for us.
+        // Otherwise it may already be reading it, so the event is dropped
+        atomic_fetch_add(&block->writers, 1);
+        if (atomic_load(&capture.currentBlock) == block) index = atomic_fetch_add(&block->count, 1);
+        if (index < TRACE_BLOCK_EVENTS) block->events[index] = (TraceEvent){ name, category, thread, start, end };
+        atomic_fetch_sub(&block->writers, 1);
+    }
+    if (index >= TRACE_BLOCK_EVENTS) atomic_fetch_add(&capture.dropped, 1);
+    atomic_fetch_sub(&capture.pushing, 1);
+}
+
+/*
+Traces every job while capturing. Runs on the thread that ran the job
+Parameter: Pointer to the finished job (*job)
+*/
+static void traceJob(const Job *job) {
+    pushTraceEvent(job->name, "job", job->worker, job->startTime, job->endTime);
+}
+
+/*
+Adds a finished zone to the current frame. Called by ProfileEnd
+Parameters: Zone (zone) and its start and end times (start, end)
+*/
+void RecordProfileZone(ProfileZone zone, double start, double end) {
+    profileZoneTime[zone] += end - start;
+    if (capturing) pushTraceEvent(ZONE_NAMES[zone] + strspn(ZONE_NAMES[zone], " "), "frame", 0, start, end);
+}
+
+/*
+Writer thread: saves the blocks the main thread hands over, until the capture stops
+Parameter: Unused (arg)
+*/
+static void *writeTrace(void *arg) {
+    (void)arg;
+    bool first = true;
+    pthread_mutex_lock(&capture.lock);
+    while (true) {
+        while (capture.written == capture.submitted && !capture.stopping) pthread_cond_wait(&capture.changed, &capture.lock);
+        if (capture.written == capture.submitted) break; // Stopping and nothing left
+        TraceBlock *block = &capture.blocks[capture.written % TRACE_BLOCKS];
+        pthread_mutex_unlock(&capture.lock);
+
+        // Events that were reserved before the block was handed over are stored within nanoseconds
+        while (atomic_load(&block->writers) > 0) sched_yield();
+        int count = atomic_load(&block->count);
+        if (count > TRACE_BLOCK_EVENTS) count = TRACE_BLOCK_EVENTS;
+        for (int i = 0; i < count; i++) {
+            const TraceEvent *event = &block->events[i];
+            fprintf(capture.file, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    first ? "" : ",\n", event->name, event->category, event->thread,
+                    (event->start - capture.start) * 1e6, (event->end - event->start) * 1e6);
+            first = false;
+        }
+        capture.eventsWritten += count;
+
+        pthread_mutex_lock(&capture.lock);
+        capture.written++;
+        pthread_cond_broadcast(&capture.changed);
+    }
+    pthread_mutex_unlock(&capture.lock);
+
+    // Thread names, so that the viewer labels the rows
+    for (int t = 0; t <= GetJobWorkerCount(); t++) {
+        fprintf(capture.file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s %d\"}}",
+                first ? "" : ",\n", t, (t == 0) ? "main" : "worker", t);
+        first = false;
+    }
+    fprintf(capture.file, "\n]}\n");
+    return NULL;
+}
+
+/*
+Hands the block being filled to the writer thread and starts filling the next free one. Called by the main thread between frames,
+jobs may still be adding events
+*/
+static void submitTraceBlock(void) {
+    pthread_mutex_lock(&capture.lock);
+    if (atomic_load(&capture.currentBlock) != NULL) {
+        capture.submitted++;
+        atomic_store(&capture.currentBlock, NULL);
+        pthread_cond_broadcast(&capture.changed);
+    }
+    if (capture.submitted - capture.written < TRACE_BLOCKS) {
+        TraceBlock *next = &capture.blocks[capture.submitted % TRACE_BLOCKS];
+        atomic_store(&next->count, 0);
+        atomic_store(&capture.currentBlock, next);
+    }
+    pthread_mutex_unlock(&capture.lock);
+}
+
+/*
+Starts saving every zone and job, on every thread, to a trace file (Chrome trace event format, opens in chrome://tracing or Perfetto)
+named after the current time. The capture stops by itself after the given time
+Parameter: Length of the capture in seconds (seconds)
+Returns: true if the capture started. false if one is already running or the file can't be created
+*/
+bool StartProfilerCapture(float seconds) {
+    if (capturing) return false;
+
+    time_t now = time(NULL);
+    strftime(capture.path, sizeof(capture.path), "trace_%Y%m%d_%H%M%S.json", localtime(&now));
+    capture.file = fopen(capture.path, "w");
+    if (capture.file == NULL) {
+        TraceLog(LOG_WARNING, "PROFILER: Could not create %s", capture.path);
+        return false;
+    }
+    setvbuf(capture.file, NULL, _IOFBF, TRACE_FILE_BUFFER);
+    fprintf(capture.file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    capture.blocks = malloc(TRACE_BLOCKS * sizeof(TraceBlock));
+    if (capture.blocks == NULL) {
+        fclose(capture.file);
+        return false;
+    }
+    capture.start = GetPreciseTime();
+    capture.end = capture.start + seconds;
+    atomic_store(&capture.dropped, 0);
+    atomic_store(&capture.pushing, 0);
+    capture.submitted = 0;
+    capture.written = 0;
+    capture.stopping = false;
+    capture.eventsWritten = 0;
+    for (int b = 0; b < TRACE_BLOCKS; b++) {
+        atomic_store(&capture.blocks[b].count, 0);
+        atomic_store(&capture.blocks[b].writers, 0);
+    }
+    atomic_store(&capture.currentBlock, &capture.blocks[0]);
+    pthread_mutex_init(&capture.lock, NULL);
+    pthread_cond_init(&capture.changed, NULL);
+    if (pthread_create(&capture.writer, NULL, writeTrace, NULL) != 0) {
+        fclose(capture.file);
+        free(capture.blocks);
+        return false;
+    }
+
+    capturing = true;
+    SetJobObserver(traceJob);
+    updateRecording();
+    TraceLog(LOG_INFO, "PROFILER: Capturing %.1f s to %s", seconds, capture.path);
+    return true;
+}
+
+/*
+Ends the capture early (or on time, from ProfilerNewFrame): waits for the writer thread to save the rest and closes the file
+*/
+void StopProfilerCapture(void) {
+    if (!capturing) return;
+
+    SetJobObserver(NULL);
+    submitTraceBlock();
+    pthread_mutex_lock(&capture.lock);
+    atomic_store(&capture.currentBlock, NULL);
+    capture.stopping = true;
+    pthread_cond_broadcast(&capture.changed);
+    pthread_mutex_unlock(&capture.lock);
+    pthread_join(capture.writer, NULL);
+
+    // An observer call that started before SetJobObserver(NULL) may still be pushing. Any push that starts now sees no block
+    while (atomic_load(&capture.pushing) > 0) sched_yield();
+    fclose(capture.file);
+    free(capture.blocks);
+    pthread_mutex_destroy(&capture.lock);
+    pthread_cond_destroy(&capture.changed);
+    capturing = false;
+    updateRecording();
+    TraceLog(LOG_INFO, "PROFILER: Saved %lld events to %s (%d dropped)", capture.eventsWritten, capture.path, atomic_load(&capture.dropped));
+}
+
+/*
+Checks if a trace capture is running
+Returns: true if capturing. Otherwise, false
+*/
+bool IsProfilerCapturing(void) {
+    return capturing;
+}
+
+/*
+Closes the current frame: saves its zone times in the ring buffer, hands the frame's trace events to the writer and starts the next frame.
+Called once per frame by the main thread
+*/
+void ProfilerNewFrame(void) {
+    if (!profilerRecording) return;
+
+    double now = GetPreciseTime();
+    profileZoneTime[PROFILE_FRAME] = now - frameStart;
+
+    if (profilerEnabled) {
+        for (int z = 0; z < PROFILE_ZONE_COUNT; z++) history[historyNext][z] = (float)(profileZoneTime[z] * 1000.0);
+        historyNext = (historyNext + 1) % PROFILER_FRAMES;
+        if (historyCount < PROFILER_FRAMES) historyCount++;
+    }
+    if (capturing) {
+        pushTraceEvent(ZONE_NAMES[PROFILE_FRAME], "frame", 0, frameStart, now);
+        // Blocks go to the writer half full, so that a frame never runs out of room and the writer wakes up rarely
+        TraceBlock *block = atomic_load(&capture.currentBlock);
+        if (now >= capture.end) StopProfilerCapture();
+        else if (block == NULL || atomic_load(&block->count) >= TRACE_BLOCK_EVENTS / 2) submitTraceBlock();
+    }
+
+    memset(profileZoneTime, 0, sizeof(profileZoneTime));
+    frameStart = now;
+}
+
+/*
+Compares two floats, for qsort
+Parameters: Pointers to the floats (*a, *b)
+Returns: Negative, zero or positive (int)
+*/
+static int compareFloats(const void *a, const void *b) {
+    float x = *(const float *)a;
+    float y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+Draws the overlay: average, 99th percentile and maximum of every zone over the recorded frames, and a graph of the frame times.
+During a capture, also a line with the time left
+Parameters: Top left corner of the panel (x, y)
+*/
+void DrawProfiler(int x, int y) {
+    if (capturing) {
+        DrawText(TextFormat("TRACE %.1f s", capture.end - GetPreciseTime()), x, y - 16, 10, RED);
+    }
+    if (!profilerEnabled) return;
+
+    int panelHeight = 24 + (PROFILE_ZONE_COUNT + 1) * ROW_HEIGHT + GRAPH_HEIGHT;
+    DrawRectangle(x, y, PANEL_WIDTH, panelHeight, Fade(BLACK, 0.75f));
+    DrawText(TextFormat("PROFILER  %d frames (F3)", historyCount), x + 8, y + 6, 10, YELLOW);
+
+    int rowY = y + 24;
+    DrawText("ms", x + 8, rowY, 10, GRAY);
+    DrawText("avg", x + 150, rowY, 10, GRAY);
+    DrawText("p99", x + 210, rowY, 10, GRAY);
+    DrawText("max", x + 270, rowY, 10, GRAY);
+
+    float sorted[PROFILER_FRAMES];
+    for (int z = 0; z < PROFILE_ZONE_COUNT; z++) {
+        rowY += ROW_HEIGHT;
+        float sum = 0;
+        for (int i = 0; i < historyCount; i++) {
+            sorted[i] = history[i][z];
+            sum += sorted[i];
+        }
+        float average = 0, p99 = 0, max = 0;
+        if (historyCount > 0) {
+            qsort(sorted, historyCount, sizeof(float), compareFloats);
+            average = sum / historyCount;
+            p99 = sorted[(historyCount - 1) * 99 / 100];
+            max = sorted[historyCount - 1];
+        }
+
+        Color color = (z == PROFILE_FRAME && p99 > FRAME_BUDGET) ? RED : RAYWHITE;
+        DrawText(ZONE_NAMES[z], x + 8, rowY, 10, color);
+        DrawText(TextFormat("%6.2f", average), x + 150, rowY, 10, color);
+        DrawText(TextFormat("%6.2f", p99), x + 210, rowY, 10, color);
+        DrawText(TextFormat("%6.2f", max), x + 270, rowY, 10, color);
+    }
+
+    // Frame times, oldest on the left. The scale fits two budgets, longer frames are clipped
+    int graphX = x + (PANEL_WIDTH - PROFILER_FRAMES) / 2;
+    int graphBottom = y + panelHeight - 6;
+    float pixelsPerMs = (GRAPH_HEIGHT - 12) / (2 * FRAME_BUDGET);
+    for (int i = 0; i < historyCount; i++) {
+        int row = (historyNext - historyCount + i + PROFILER_FRAMES) % PROFILER_FRAMES;
+        float frame = history[row][PROFILE_FRAME];
+        int height = (int)(frame * pixelsPerMs);
+        if (height > GRAPH_HEIGHT - 12) height = GRAPH_HEIGHT - 12;
+        DrawRectangle(graphX + (PROFILER_FRAMES - historyCount) + i, graphBottom - height, 1, height, (frame > FRAME_BUDGET) ? RED : LIME);
+    }
+    int budgetY = graphBottom - (int)(FRAME_BUDGET * pixelsPerMs);
+    DrawLine(graphX, budgetY, graphX + PROFILER_FRAMES, budgetY, YELLOW);
+    DrawText("16.6", graphX + PROFILER_FRAMES - 22, budgetY - 10, 10, YELLOW);
+}
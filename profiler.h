@@ -0,0 +1,70 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+#include "platform.h"
+
+#define PROFILER_FRAMES 300 // Frames kept in the ring buffer (5 seconds at 60 FPS)
+#define DEFAULT_TRACE_SECONDS 5.0f // Length of a trace capture started with F4
+
+// Phases of a frame. Zones may nest (traffic runs inside the simulation) and may run several times per frame (once per tick), their times add up
+typedef enum {
+    PROFILE_FRAME,      // From one ProfilerNewFrame to the next, filled in automatically
+    PROFILE_MUSIC,
+    PROFILE_TILE_STREAMING,
+    PROFILE_SIMULATION,
+    PROFILE_TRAFFIC,
+    PROFILE_ORDERS,
+    PROFILE_MOVEMENT,
+    PROFILE_CAMERA,
+    PROFILE_WORLD_DRAW,
+    PROFILE_MINIMAP_DRAW,
+    PROFILE_HUD,
+    PROFILE_PRESENT,    // EndDrawing: buffer swap and waiting for the target FPS
+    PROFILE_ZONE_COUNT
+} ProfileZone;
+
+// The overlay is shown while profilerEnabled is true. Zones are recorded (for the overlay, a trace capture or both) while profilerRecording is true,
+// otherwise they cost one branch each
+extern bool profilerEnabled;
+extern bool profilerRecording;
+extern double profileZoneStart[PROFILE_ZONE_COUNT];
+
+// functions
+void SetProfilerEnabled(bool enabled);
+void RecordProfileZone(ProfileZone zone, double start, double end);
+void ProfilerNewFrame(void);
+void DrawProfiler(int x, int y);
+bool StartProfilerCapture(float seconds);
+void StopProfilerCapture(void);
+bool IsProfilerCapturing(void);
+
+/*
+Starts timing a zone of the current frame
+Parameter: Zone (zone)
+*/
+static inline void ProfileBegin(ProfileZone zone) {
+    if (profilerRecording) profileZoneStart[zone] = GetPreciseTime();
+}
+
+/*
+Stops timing a zone, adds the time to the current frame and, during a capture, saves it as a trace event
+Parameter: Zone (zone)
+*/
+static inline void ProfileEnd(ProfileZone zone) {
+    if (profilerRecording) RecordProfileZone(zone, profileZoneStart[zone], GetPreciseTime());
+}
+
+#endif
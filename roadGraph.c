@@ -0,0 +1,776 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "raylib.h"
+#include "roadGraph.h"
+#include "platform.h"
+
+#define ROAD_GRAPH_ALIGNMENT 8 // Every array of the graph's block starts at a multiple of this
+
+// --- ROAD GRAPH CONSTANTS ---
+static const float SPUR_CLEARANCE_FACTOR = 2.5f; // A dead end shorter than this many times its junction's clearance is a thinning artifact (a corner), not a road
+static const float SPUR_MIN_LENGTH = 6.0f;
+static const float MIN_COMPONENT_LENGTH = 64.0f; // Networks with less road than this (signs, specks of paint) are dropped
+static const float SIMPLIFY_TOLERANCE = 1.0f;    // Pixels a simplified centerline may stray from the skeleton
+
+// 8-neighbourhood, clockwise from north (P2..P9 in Zhang-Suen's paper)
+static const int DX[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+static const int DY[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+
+// Growable arrays for the extraction
+typedef struct {
+    int *items;
+    int count;
+    int capacity;
+} IndexList;
+
+typedef struct {
+    Vector2 *items;
+    int count;
+    int capacity;
+} PointList;
+
+// A node while the graph is being simplified
+typedef struct {
+    Vector2 position;
+    float clearance; // Largest distance to a wall among the node's pixels
+    int degree;
+} WorkNode;
+
+// A segment while the graph is being simplified. Its raw skeleton pixels are a range of a PointList
+typedef struct {
+    int nodes[2];
+    float length;
+    float clearance; // Smallest distance to a wall along the segment
+    int first;
+    int count;
+    bool removed;
+} WorkEdge;
+
+typedef struct {
+    WorkNode *nodes;
+    int nodeCount;
+    int nodeCapacity;
+    WorkEdge *edges;
+    int edgeCount;
+    int edgeCapacity;
+    PointList raw; // Skeleton pixels of every edge
+} WorkGraph;
+
+/*
+Appends an index to a list, growing it when full
+Parameters: Pointer to the list (*list) and the index (value)
+*/
+static void pushIndex(IndexList *list, int value) {
+    if (list->count == list->capacity) {
+        list->capacity = (list->capacity == 0) ? 1024 : list->capacity * 2;
+        list->items = realloc(list->items, list->capacity * sizeof(int));
+    }
+    list->items[list->count++] = value;
+}
+
+/*
+Appends a point to a list, growing it when full
+Parameters: Pointer to the list (*list) and the point (point)
+*/
+static void pushPoint(PointList *list, Vector2 point) {
+    if (list->count == list->capacity) {
+        list->capacity = (list->capacity == 0) ? 1024 : list->capacity * 2;
+        list->items = realloc(list->items, list->capacity * sizeof(Vector2));
+    }
+    list->items[list->count++] = point;
+}
+
+/*
+Adds a node to the work graph
+Parameters: Pointer to the graph (*graph), node's position (position) and clearance (clearance)
+Returns: Node's index (int)
+*/
+static int addWorkNode(WorkGraph *graph, Vector2 position, float clearance) {
+    if (graph->nodeCount == graph->nodeCapacity) {
+        graph->nodeCapacity = (graph->nodeCapacity == 0) ? 256 : graph->nodeCapacity * 2;
+        graph->nodes = realloc(graph->nodes, graph->nodeCapacity * sizeof(WorkNode));
+    }
+    graph->nodes[graph->nodeCount] = (WorkNode){ position, clearance, 0 };
+    return graph->nodeCount++;
+}
+
+/*
+Adds an edge to the work graph
+Parameters: Pointer to the graph (*graph) and the edge (edge)
+*/
+static void addWorkEdge(WorkGraph *graph, WorkEdge edge) {
+    if (graph->edgeCount == graph->edgeCapacity) {
+        graph->edgeCapacity = (graph->edgeCapacity == 0) ? 256 : graph->edgeCapacity * 2;
+        graph->edges = realloc(graph->edges, graph->edgeCapacity * sizeof(WorkEdge));
+    }
+    graph->edges[graph->edgeCount++] = edge;
+}
+
+/*
+Checks if a pixel may be peeled off in one sub-iteration of Zhang-Suen thinning
+Parameters: Padded road image (*image), pixel's index (p), offsets of its 8 neighbours (offsets) and sub-iteration (step, 0 or 1)
+Returns: true if the pixel can be removed without breaking the road apart or eating a line's end
+*/
+static bool canPeel(const uint8_t *image, int p, const int offsets[8], int step) {
+    bool n[8];
+    int neighbours = 0;
+    for (int k = 0; k < 8; k++) {
+        n[k] = image[p + offsets[k]] != 0;
+        neighbours += n[k];
+    }
+    if (neighbours < 2 || neighbours > 6) return false;
+
+    int transitions = 0; // Background to road, going round the pixel
+    for (int k = 0; k < 8; k++) transitions += !n[k] && n[(k + 1) & 7];
+    if (transitions != 1) return false;
+
+    // n[0] north, n[2] east, n[4] south, n[6] west
+    if (step == 0) return !(n[0] && n[2] && n[4]) && !(n[2] && n[4] && n[6]);
+    return !(n[0] && n[2] && n[6]) && !(n[0] && n[4] && n[6]);
+}
+
+/*
+Thins the road down to its 1 pixel wide skeleton (Zhang-Suen). Only pixels next to a removed one are checked again,
+so the work follows the shrinking outline instead of rescanning the whole map every pass
+Parameters: Padded road image (*image, 1 for road) and map's dimensions (width, height)
+*/
+static void thinRoad(uint8_t *image, int width, int height) {
+    int stride = width + 2;
+    int offsets[8];
+    for (int k = 0; k < 8; k++) offsets[k] = DY[k] * stride + DX[k];
+
+    uint8_t *queued = calloc((size_t)stride * (height + 2), 1);
+    IndexList candidates = {0}, next = {0}, peeled = {0};
+
+    // Start from the outline
+    for (int y = 1; y <= height; y++) {
+        for (int x = 1; x <= width; x++) {
+            int p = y * stride + x;
+            if (image[p] && (!image[p - stride] || !image[p + stride] || !image[p - 1] || !image[p + 1])) pushIndex(&candidates, p);
+        }
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int step = 0; step < 2; step++) {
+            peeled.count = 0;
+            for (int i = 0; i < candidates.count; i++) {
+                int p = candidates.items[i];
+                if (image[p] && canPeel(image, p, offsets, step)) pushIndex(&peeled, p);
+            }
+            for (int i = 0; i < peeled.count; i++) image[peeled.items[i]] = 0;
+            if (peeled.count > 0) changed = true;
+
+            // Next candidates: the ones still standing and the neighbours of the removed pixels
+            next.count = 0;
+            for (int i = 0; i < candidates.count; i++) {
+                int p = candidates.items[i];
+                if (image[p] && !queued[p]) {
+                    queued[p] = 1;
+                    pushIndex(&next, p);
+                }
+            }
+            for (int i = 0; i < peeled.count; i++) {
+                for (int k = 0; k < 8; k++) {
+                    int q = peeled.items[i] + offsets[k];
+                    if (image[q] && !queued[q]) {
+                        queued[q] = 1;
+                        pushIndex(&next, q);
+                    }
+                }
+            }
+            for (int i = 0; i < next.count; i++) queued[next.items[i]] = 0;
+
+            IndexList swap = candidates;
+            candidates = next;
+            next = swap;
+        }
+    }
+
+    free(candidates.items);
+    free(next.items);
+    free(peeled.items);
+    free(queued);
+}
+
+/*
+Finds the length of a polyline
+Parameters: Points (*points) and their number (count)
+Returns: Length in pixels (float)
+*/
+static float polylineLength(const Vector2 *points, int count) {
+    float length = 0;
+    for (int i = 1; i < count; i++) length += hypotf(points[i].x - points[i - 1].x, points[i].y - points[i - 1].y);
+    return length;
+}
+
+/*
+Adds a traced stretch of skeleton as an edge. A loop that comes back to its own node gets a node in its middle,
+so that every edge joins two different nodes
+Parameters: Pointer to the graph (*graph), end nodes (from, to), index of its first raw pixel (first), minimum clearance (clearance)
+*/
+static void addTracedEdge(WorkGraph *graph, int from, int to, int first, float clearance) {
+    int count = graph->raw.count - first;
+    WorkEdge edge = { { from, to }, polylineLength(graph->raw.items + first, count), clearance, first, count, false };
+    if (from != to) {
+        addWorkEdge(graph, edge);
+        return;
+    }
+    if (count < 5) return; // A bubble in the skeleton, not a road
+
+    int middle = count / 2;
+    int split = addWorkNode(graph, graph->raw.items[first + middle], clearance);
+    WorkEdge firstHalf = { { from, split }, polylineLength(graph->raw.items + first, middle + 1), clearance, first, middle + 1, false };
+    WorkEdge secondHalf = { { split, to }, polylineLength(graph->raw.items + first + middle, count - middle), clearance, first + middle, count - middle, false };
+    addWorkEdge(graph, firstHalf);
+    addWorkEdge(graph, secondHalf);
+}
+
+/*
+Turns a skeleton into a graph: pixels with other than 2 neighbours become nodes (touching ones merge into one),
+runs of pixels with exactly 2 neighbours become edges
+Parameters: Padded skeleton (*image), map's dimensions (width, height), distance field (*wallDistance) and the graph to fill (*graph)
+*/
+static void traceSkeleton(const uint8_t *image, int width, int height, const uint8_t *wallDistance, WorkGraph *graph) {
+    int stride = width + 2;
+    size_t total = (size_t)stride * (height + 2);
+    int offsets[8];
+    for (int k = 0; k < 8; k++) offsets[k] = DY[k] * stride + DX[k];
+
+    uint8_t *neighbours = calloc(total, 1);
+    int *label = malloc(total * sizeof(int)); // Node of every node pixel, -1 elsewhere
+    uint8_t *visited = calloc(total, 1);
+    for (size_t p = 0; p < total; p++) label[p] = -1;
+
+    for (int y = 1; y <= height; y++) {
+        for (int x = 1; x <= width; x++) {
+            int p = y * stride + x;
+            if (!image[p]) continue;
+            for (int k = 0; k < 8; k++) neighbours[p] += image[p + offsets[k]] != 0;
+        }
+    }
+
+    // 1. Nodes: clusters of touching node pixels
+    IndexList nodePixels = {0}, stack = {0};
+    for (int y = 1; y <= height; y++) {
+        for (int x = 1; x <= width; x++) {
+            int p = y * stride + x;
+            if (!image[p] || neighbours[p] == 2 || label[p] >= 0) continue;
+
+            int node = addWorkNode(graph, (Vector2){ 0, 0 }, 0);
+            Vector2 sum = { 0, 0 };
+            int pixels = 0;
+            float clearance = 0;
+            label[p] = node;
+            stack.count = 0;
+            pushIndex(&stack, p);
+            while (stack.count > 0) {
+                int q = stack.items[--stack.count];
+                int qx = q % stride - 1, qy = q / stride - 1;
+                sum.x += qx;
+                sum.y += qy;
+                pixels++;
+                if (wallDistance[(size_t)qy * width + qx] > clearance) clearance = wallDistance[(size_t)qy * width + qx];
+                pushIndex(&nodePixels, q);
+
+                for (int k = 0; k < 8; k++) {
+                    int r = q + offsets[k];
+                    if (image[r] && neighbours[r] != 2 && label[r] < 0) {
+                        label[r] = node;
+                        pushIndex(&stack, r);
+                    }
+                }
+            }
+            graph->nodes[node].position = (Vector2){ sum.x / pixels, sum.y / pixels };
+            graph->nodes[node].clearance = clearance;
+        }
+    }
+
+    // 2. Edges: walk from every node pixel along each unvisited run. Rings with no node at all get one on their first pixel
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < nodePixels.count; i++) {
+            int p = nodePixels.items[i];
+            for (int k = 0; k < 8; k++) {
+                int q = p + offsets[k];
+                if (!image[q] || label[q] >= 0 || visited[q]) continue;
+
+                int first = graph->raw.count;
+                pushPoint(&graph->raw, (Vector2){ p % stride - 1, p / stride - 1 });
+                float clearance = 255;
+                int previous = p, current = q, end = -1;
+                while (true) {
+                    int cx = current % stride - 1, cy = current / stride - 1;
+                    visited[current] = 1;
+                    pushPoint(&graph->raw, (Vector2){ cx, cy });
+                    if (wallDistance[(size_t)cy * width + cx] < clearance) clearance = wallDistance[(size_t)cy * width + cx];
+
+                    int following = -1;
+                    for (int j = 0; j < 8; j++) {
+                        int r = current + offsets[j];
+                        if (image[r] && r != previous) following = r;
+                    }
+                    if (following < 0 || (label[following] < 0 && visited[following])) break;
+                    if (label[following] >= 0) {
+                        end = label[following];
+                        pushPoint(&graph->raw, (Vector2){ following % stride - 1, following / stride - 1 });
+                        break;
+                    }
+                    previous = current;
+                    current = following;
+                }
+
+                if (end >= 0) addTracedEdge(graph, label[p], end, first, clearance);
+                else graph->raw.count = first;
+            }
+        }
+        if (pass == 1) break;
+
+        // Rings: everything left unvisited
+        nodePixels.count = 0;
+        for (int y = 1; y <= height; y++) {
+            for (int x = 1; x <= width; x++) {
+                int p = y * stride + x;
+                if (!image[p] || label[p] >= 0 || visited[p]) continue;
+                label[p] = addWorkNode(graph, (Vector2){ x - 1, y - 1 }, wallDistance[(size_t)(y - 1) * width + x - 1]);
+                visited[p] = 1;
+                pushIndex(&nodePixels, p);
+                // Claim the rest of the ring now, so that it gets only this node
+                int previous = p, current = p;
+                while (true) {
+                    int following = -1;
+                    for (int j = 0; j < 8; j++) {
+                        int r = current + offsets[j];
+                        if (image[r] && r != previous && !visited[r] && label[r] < 0) following = r;
+                    }
+                    if (following < 0) break;
+                    visited[following] = 2; // Seen, but still to be traced
+                    previous = current;
+                    current = following;
+                }
+            }
+        }
+        for (size_t p = 0; p < total; p++) if (visited[p] == 2) visited[p] = 0;
+    }
+
+    free(stack.items);
+    free(nodePixels.items);
+    free(visited);
+    free(label);
+    free(neighbours);
+}
+
+/*
+Merges the two edges of a node that only joins them, so that nodes are intersections and dead ends only
+Parameters: Pointer to the graph (*graph), the node (node) and its two edges (a, b)
+*/
+static void dissolveNode(WorkGraph *graph, int node, int a, int b) {
+    WorkEdge *first = &graph->edges[a];
+    WorkEdge *second = &graph->edges[b];
+    int start = (first->nodes[0] == node) ? first->nodes[1] : first->nodes[0];
+    int end = (second->nodes[0] == node) ? second->nodes[1] : second->nodes[0];
+
+    // New raw range: first edge towards the node, then second edge away from it
+    int merged = graph->raw.count;
+    for (int i = 0; i < first->count; i++) {
+        int index = (first->nodes[1] == node) ? i : first->count - 1 - i;
+        pushPoint(&graph->raw, graph->raw.items[first->first + index]);
+    }
+    for (int i = 1; i < second->count; i++) {
+        int index = (second->nodes[0] == node) ? i : second->count - 1 - i;
+        pushPoint(&graph->raw, graph->raw.items[second->first + index]);
+    }
+
+    first->nodes[0] = start;
+    first->nodes[1] = end;
+    first->length += second->length;
+    if (second->clearance < first->clearance) first->clearance = second->clearance;
+    first->first = merged;
+    first->count = graph->raw.count - merged;
+    second->removed = true;
+    graph->nodes[node].degree = 0;
+}
+
+/*
+Finds a node's representative in the union-find forest, halving the path on the way
+Parameters: Parent of every node (*parent) and the node (node)
+Returns: Representative (int)
+*/
+static int findRoot(int *parent, int node) {
+    while (parent[node] != node) {
+        parent[node] = parent[parent[node]];
+        node = parent[node];
+    }
+    return node;
+}
+
+/*
+Cleans up the traced graph: removes the short spurs that thinning leaves in corners and wide areas, merges the edges
+of nodes that just join two of them, and drops tiny networks
+Parameter: Pointer to the graph (*graph)
+*/
+static void simplifyGraph(WorkGraph *graph) {
+    int *incidentStart = malloc((graph->nodeCount + 1) * sizeof(int));
+    int *incident = NULL;
+    uint8_t *touched = NULL;
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        for (int n = 0; n < graph->nodeCount; n++) graph->nodes[n].degree = 0;
+        for (int e = 0; e < graph->edgeCount; e++) {
+            WorkEdge *edge = &graph->edges[e];
+            if (edge->removed) continue;
+            graph->nodes[edge->nodes[0]].degree++;
+            graph->nodes[edge->nodes[1]].degree++;
+        }
+
+        // 1. Spurs
+        for (int e = 0; e < graph->edgeCount; e++) {
+            WorkEdge *edge = &graph->edges[e];
+            if (edge->removed) continue;
+            for (int side = 0; side < 2; side++) {
+                WorkNode *tip = &graph->nodes[edge->nodes[side]];
+                WorkNode *junction = &graph->nodes[edge->nodes[1 - side]];
+                if (tip->degree != 1 || junction->degree < 3) continue;
+                if (edge->length >= SPUR_CLEARANCE_FACTOR * junction->clearance + SPUR_MIN_LENGTH) continue;
+                edge->removed = true;
+                tip->degree--;
+                junction->degree--;
+                changed = true;
+                break;
+            }
+        }
+
+        // 2. Nodes with two edges. Each edge takes part in one merge per round, the next round sees the result
+        incidentStart[0] = 0;
+        for (int n = 0; n < graph->nodeCount; n++) incidentStart[n + 1] = incidentStart[n] + graph->nodes[n].degree;
+        incident = realloc(incident, (incidentStart[graph->nodeCount] + 1) * sizeof(int));
+        free(touched);
+        touched = calloc(graph->edgeCount + 1, 1);
+        for (int n = 0; n < graph->nodeCount; n++) graph->nodes[n].degree = 0;
+        for (int e = 0; e < graph->edgeCount; e++) {
+            WorkEdge *edge = &graph->edges[e];
+            if (edge->removed) continue;
+            for (int side = 0; side < 2; side++) {
+                int n = edge->nodes[side];
+                incident[incidentStart[n] + graph->nodes[n].degree++] = e;
+            }
+        }
+        for (int n = 0; n < graph->nodeCount; n++) {
+            if (graph->nodes[n].degree != 2) continue;
+            int a = incident[incidentStart[n]], b = incident[incidentStart[n] + 1];
+            if (touched[a] || touched[b] || a == b) continue;
+            int otherA = (graph->edges[a].nodes[0] == n) ? graph->edges[a].nodes[1] : graph->edges[a].nodes[0];
+            int otherB = (graph->edges[b].nodes[0] == n) ? graph->edges[b].nodes[1] : graph->edges[b].nodes[0];
+            if (otherA == otherB) continue; // Would close a loop on itself
+            dissolveNode(graph, n, a, b);
+            touched[a] = touched[b] = 1;
+            changed = true;
+        }
+    }
+
+    // 3. Tiny networks
+    int *parent = malloc(graph->nodeCount * sizeof(int));
+    float *roadLength = calloc(graph->nodeCount, sizeof(float));
+    for (int n = 0; n < graph->nodeCount; n++) parent[n] = n;
+    for (int e = 0; e < graph->edgeCount; e++) {
+        WorkEdge *edge = &graph->edges[e];
+        if (!edge->removed) parent[findRoot(parent, edge->nodes[0])] = findRoot(parent, edge->nodes[1]);
+    }
+    for (int e = 0; e < graph->edgeCount; e++) {
+        WorkEdge *edge = &graph->edges[e];
+        if (!edge->removed) roadLength[findRoot(parent, edge->nodes[0])] += edge->length;
+    }
+    for (int e = 0; e < graph->edgeCount; e++) {
+        WorkEdge *edge = &graph->edges[e];
+        if (!edge->removed && roadLength[findRoot(parent, edge->nodes[0])] < MIN_COMPONENT_LENGTH) edge->removed = true;
+    }
+
+    free(roadLength);
+    free(parent);
+    free(touched);
+    free(incident);
+    free(incidentStart);
+}
+
+/*
+Simplifies a polyline (Douglas-Peucker): keeps the points that stray more than SIMPLIFY_TOLERANCE from the line between the kept ones
+Parameters: Points (*points), their number (count) and the flags to fill, 1 for kept points (*keep)
+*/
+static void simplifyPolyline(const Vector2 *points, int count, uint8_t *keep) {
+    memset(keep, 0, count);
+    keep[0] = keep[count - 1] = 1;
+
+    IndexList ranges = {0};
+    pushIndex(&ranges, 0);
+    pushIndex(&ranges, count - 1);
+    while (ranges.count > 0) {
+        int last = ranges.items[--ranges.count];
+        int first = ranges.items[--ranges.count];
+        Vector2 a = points[first], b = points[last];
+        float dx = b.x - a.x, dy = b.y - a.y;
+        float length = hypotf(dx, dy);
+
+        int farthest = -1;
+        float farthestDistance = SIMPLIFY_TOLERANCE;
+        for (int i = first + 1; i < last; i++) {
+            float distance = (length > 0) ? fabsf(dx * (a.y - points[i].y) - dy * (a.x - points[i].x)) / length
+                                          : hypotf(points[i].x - a.x, points[i].y - a.y);
+            if (distance > farthestDistance) {
+                farthestDistance = distance;
+                farthest = i;
+            }
+        }
+        if (farthest < 0) continue;
+        keep[farthest] = 1;
+        pushIndex(&ranges, first);
+        pushIndex(&ranges, farthest);
+        pushIndex(&ranges, farthest);
+        pushIndex(&ranges, last);
+    }
+    free(ranges.items);
+}
+
+/*
+Points a graph's arrays into its block and finds the block's size
+Parameters: Pointer to the graph (*graph) with its counts set, and the block (*memory), NULL to only measure it
+Returns: Block's size in bytes (size_t)
+*/
+static size_t layoutRoadGraph(RoadGraph *graph, void *memory) {
+    size_t sizes[6] = {
+        (size_t)graph->nodeCount * sizeof(Vector2),
+        ((size_t)graph->nodeCount + 1) * sizeof(uint32_t),
+        (size_t)graph->segmentCount * 2 * sizeof(uint32_t),
+        (size_t)graph->segmentCount * 2 * sizeof(uint32_t),
+        (size_t)graph->segmentCount * sizeof(RoadSegment),
+        (size_t)graph->pointCount * sizeof(Vector2),
+    };
+    void **arrays[6] = {
+        (void **)&graph->nodes, (void **)&graph->edgeStart, (void **)&graph->edgeTarget,
+        (void **)&graph->edgeSegment, (void **)&graph->segments, (void **)&graph->points
+    };
+
+    size_t offset = 4 * sizeof(uint32_t); // Header: node, segment and point counts, then a spare word
+    for (int i = 0; i < 6; i++) {
+        offset = (offset + ROAD_GRAPH_ALIGNMENT - 1) / ROAD_GRAPH_ALIGNMENT * ROAD_GRAPH_ALIGNMENT;
+        if (memory != NULL) *arrays[i] = (unsigned char *)memory + offset;
+        offset += sizes[i];
+    }
+    return offset;
+}
+
+/*
+Extracts the road network from the distance field: thins the road (every pixel at least ROAD_MIN_CLEARANCE from a wall)
+down to its centerline, turns the centerline into nodes and segments and stores them in one block
+Parameters: Distance of every pixel to the nearest wall (*wallDistance) and map's dimensions (width, height)
+Returns: The road graph (RoadGraph). Must be freed with UnloadRoadGraph
+*/
+RoadGraph BuildRoadGraph(const uint8_t *wallDistance, int width, int height) {
+    double start = GetPreciseTime();
+    int stride = width + 2;
+    uint8_t *image = calloc((size_t)stride * (height + 2), 1); // One pixel of background all around, so neighbours never leave the image
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) image[(size_t)(y + 1) * stride + x + 1] = wallDistance[(size_t)y * width + x] >= ROAD_MIN_CLEARANCE;
+    }
+
+    thinRoad(image, width, height);
+    WorkGraph work = {0};
+    traceSkeleton(image, width, height, wallDistance, &work);
+    free(image);
+    simplifyGraph(&work);
+
+    // Number the surviving nodes and simplify the centerlines
+    int *nodeIndex = malloc((work.nodeCount + 1) * sizeof(int));
+    for (int n = 0; n < work.nodeCount; n++) nodeIndex[n] = -1;
+    RoadGraph graph = {0};
+    int longest = 1;
+    for (int e = 0; e < work.edgeCount; e++) {
+        WorkEdge *edge = &work.edges[e];
+        if (edge->removed) continue;
+        for (int side = 0; side < 2; side++) {
+            if (nodeIndex[edge->nodes[side]] < 0) nodeIndex[edge->nodes[side]] = graph.nodeCount++;
+        }
+        graph.segmentCount++;
+        if (edge->count > longest) longest = edge->count;
+    }
+
+    // The ends sit on the nodes themselves, not on whichever pixel of the node the skeleton reached.
+    // Before simplifying, so that the bend between a node off the road's line and the road is kept
+    uint8_t *keep = malloc(longest);
+    for (int e = 0; e < work.edgeCount; e++) {
+        WorkEdge *edge = &work.edges[e];
+        if (edge->removed) continue;
+        work.raw.items[edge->first] = work.nodes[edge->nodes[0]].position;
+        work.raw.items[edge->first + edge->count - 1] = work.nodes[edge->nodes[1]].position;
+        simplifyPolyline(work.raw.items + edge->first, edge->count, keep);
+        for (int i = 0; i < edge->count; i++) graph.pointCount += keep[i];
+    }
+
+    graph.size = layoutRoadGraph(&graph, NULL);
+    graph.memory = calloc(graph.size, 1);
+    graph.ownsMemory = true;
+    layoutRoadGraph(&graph, graph.memory);
+    uint32_t *header = graph.memory;
+    header[0] = (uint32_t)graph.nodeCount;
+    header[1] = (uint32_t)graph.segmentCount;
+    header[2] = (uint32_t)graph.pointCount;
+
+    for (int n = 0; n < work.nodeCount; n++) {
+        if (nodeIndex[n] >= 0) graph.nodes[nodeIndex[n]] = work.nodes[n].position;
+    }
+
+    int segment = 0, point = 0;
+    for (int e = 0; e < work.edgeCount; e++) {
+        WorkEdge *edge = &work.edges[e];
+        if (edge->removed) continue;
+        RoadSegment *out = &graph.segments[segment++];
+        out->nodes[0] = (uint32_t)nodeIndex[edge->nodes[0]];
+        out->nodes[1] = (uint32_t)nodeIndex[edge->nodes[1]];
+        out->width = 2.0f * edge->clearance;
+        out->firstPoint = (uint32_t)point;
+
+        simplifyPolyline(work.raw.items + edge->first, edge->count, keep);
+        for (int i = 0; i < edge->count; i++) {
+            if (keep[i]) graph.points[point++] = work.raw.items[edge->first + i];
+        }
+        out->pointCount = (uint32_t)point - out->firstPoint;
+        out->length = polylineLength(graph.points + out->firstPoint, out->pointCount);
+    }
+
+    // Adjacency
+    for (int s = 0; s < graph.segmentCount; s++) {
+        graph.edgeStart[graph.segments[s].nodes[0] + 1]++;
+        graph.edgeStart[graph.segments[s].nodes[1] + 1]++;
+    }
+    for (int n = 0; n < graph.nodeCount; n++) graph.edgeStart[n + 1] += graph.edgeStart[n];
+    uint32_t *fill = malloc((graph.nodeCount + 1) * sizeof(uint32_t));
+    memcpy(fill, graph.edgeStart, graph.nodeCount * sizeof(uint32_t));
+    for (int s = 0; s < graph.segmentCount; s++) {
+        for (int side = 0; side < 2; side++) {
+            uint32_t from = graph.segments[s].nodes[side];
+            uint32_t edge = fill[from]++;
+            graph.edgeTarget[edge] = graph.segments[s].nodes[1 - side];
+            graph.edgeSegment[edge] = (uint32_t)s;
+        }
+    }
+
+    free(fill);
+    free(keep);
+    free(nodeIndex);
+    free(work.nodes);
+    free(work.edges);
+    free(work.raw.items);
+
+    TraceLog(LOG_INFO, "ROADS: %d nodes, %d segments, %d centerline points (%.1f ms)",
+             graph.nodeCount, graph.segmentCount, graph.pointCount, (GetPreciseTime() - start) * 1000.0);
+    return graph;
+}
+
+/*
+Points a graph into a block saved by a previous run (the map cache's section) and checks that it is consistent
+Parameters: Pointer to the graph to fill (*graph), the block (*data) and its size in bytes (size)
+Returns: true if the block holds a valid graph. Otherwise, false
+*/
+bool LoadRoadGraph(RoadGraph *graph, const void *data, size_t size) {
+    *graph = (RoadGraph){0};
+    if (data == NULL || size < 4 * sizeof(uint32_t)) return false;
+
+    const uint32_t *header = data;
+    if (header[0] > size || header[1] > size || header[2] > size) return false;
+    RoadGraph loaded = { .nodeCount = (int)header[0], .segmentCount = (int)header[1], .pointCount = (int)header[2] };
+    if (layoutRoadGraph(&loaded, NULL) != size) return false;
+    layoutRoadGraph(&loaded, (void *)data);
+
+    // Indices stay inside their arrays, so that a damaged cache can't send a search out of bounds
+    if (loaded.edgeStart[0] != 0 || loaded.edgeStart[loaded.nodeCount] != (uint32_t)loaded.segmentCount * 2) return false;
+    for (int n = 0; n < loaded.nodeCount; n++) {
+        if (loaded.edgeStart[n] > loaded.edgeStart[n + 1]) return false;
+    }
+    for (int e = 0; e < loaded.segmentCount * 2; e++) {
+        if (loaded.edgeTarget[e] >= (uint32_t)loaded.nodeCount || loaded.edgeSegment[e] >= (uint32_t)loaded.segmentCount) return false;
+    }
+    for (int s = 0; s < loaded.segmentCount; s++) {
+        const RoadSegment *segment = &loaded.segments[s];
+        if (segment->nodes[0] >= (uint32_t)loaded.nodeCount || segment->nodes[1] >= (uint32_t)loaded.nodeCount) return false;
+        if (segment->pointCount < 2 || segment->firstPoint > (uint32_t)loaded.pointCount ||
+            segment->pointCount > (uint32_t)loaded.pointCount - segment->firstPoint) return false;
+    }
+
+    loaded.memory = (void *)data;
+    loaded.size = size;
+    loaded.ownsMemory = false;
+    *graph = loaded;
+    return true;
+}
+
+/*
+Frees a road graph (nothing to free if it lives in the map cache)
+Parameter: Pointer to the graph (*graph)
+*/
+void UnloadRoadGraph(RoadGraph *graph) {
+    if (graph->ownsMemory) free(graph->memory);
+    *graph = (RoadGraph){0};
+}
+
+/*
+Checks which way an edge runs along its segment's centerline
+Parameters: Pointer to the graph (*graph) and edge (edge)
+Returns: true if it runs from the segment's nodes[0] to its nodes[1]. Otherwise, false
+*/
+bool IsForwardRoadEdge(const RoadGraph *graph, uint32_t edge) {
+    const RoadSegment *segment = &graph->segments[graph->edgeSegment[edge]];
+    if (segment->nodes[0] != segment->nodes[1]) return graph->edgeTarget[edge] == segment->nodes[1];
+    // A loop leaves its node twice, the forward edge first (see BuildRoadGraph)
+    return edge + 1 < graph->edgeStart[segment->nodes[0] + 1] && graph->edgeSegment[edge + 1] == graph->edgeSegment[edge];
+}
+
+/*
+Finds the edge that runs the other way along the same segment
+Parameters: Pointer to the graph (*graph) and edge (edge)
+Returns: The reverse edge (uint32_t)
+*/
+uint32_t GetReverseRoadEdge(const RoadGraph *graph, uint32_t edge) {
+    uint32_t node = graph->edgeTarget[edge];
+    bool forward = IsForwardRoadEdge(graph, edge);
+    for (uint32_t e = graph->edgeStart[node]; e < graph->edgeStart[node + 1]; e++) {
+        if (graph->edgeSegment[e] == graph->edgeSegment[edge] && IsForwardRoadEdge(graph, e) != forward) return e;
+    }
+    return edge;
+}
+
+/*
+Finds a point of an edge's centerline, counting in the direction of travel
+Parameters: Pointer to the graph (*graph), edge (edge) and point's number (k)
+Returns: The point (Vector2)
+*/
+Vector2 GetRoadEdgePoint(const RoadGraph *graph, uint32_t edge, uint32_t k) {
+    const RoadSegment *segment = &graph->segments[graph->edgeSegment[edge]];
+    return graph->points[segment->firstPoint + (IsForwardRoadEdge(graph, edge) ? k : segment->pointCount - 1 - k)];
+}
+
+/*
+Finds the heading that drives along a piece of centerline: the axis it mostly runs along
+Parameters: The piece's ends (from, to)
+Returns: Unit vector along an axis (Vector2)
+*/
+Vector2 GetRoadPieceHeading(Vector2 from, Vector2 to) {
+    float dx = to.x - from.x;
+    float dy = to.y - from.y;
+    if (fabsf(dx) > fabsf(dy)) return (Vector2){ (dx > 0) ? 1.0f : -1.0f, 0 };
+    return (Vector2){ 0, (dy > 0) ? 1.0f : -1.0f };
+}
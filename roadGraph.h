@@ -0,0 +1,57 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+#ifndef ROADGRAPH_H
+#define ROADGRAPH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "raylib.h"
+
+#define ROAD_MIN_CLEARANCE 4 // Pixels closer than this to a wall are not part of the network (a car is 8 pixels wide)
+
+// A stretch of road between two nodes (intersections or dead ends)
+typedef struct {
+    uint32_t nodes[2];
+    float length;        // Along the centerline, in pixels
+    float width;         // At the narrowest point, in pixels
+    uint32_t firstPoint; // The centerline is points[firstPoint] .. points[firstPoint + pointCount - 1], from nodes[0] to nodes[1]
+    uint32_t pointCount;
+} RoadSegment;
+
+// The road network, extracted from the road's skeleton (centerline) at bake time.
+// Adjacency is stored in compressed sparse rows: every segment appears once in each direction
+typedef struct {
+    int nodeCount;
+    int segmentCount;
+    int pointCount;
+    Vector2 *nodes;        // Position of every node
+    uint32_t *edgeStart;   // The edges leaving node n are edgeStart[n] .. edgeStart[n + 1] - 1 (nodeCount + 1 entries)
+    uint32_t *edgeTarget;  // Node at the other end of every edge
+    uint32_t *edgeSegment; // Segment of every edge
+    RoadSegment *segments;
+    Vector2 *points;       // Simplified centerlines of all segments
+    void *memory;          // One block with every array above, in the same layout as the map cache's section
+    size_t size;           // Block's size in bytes
+    bool ownsMemory;       // false when the block lives in the map cache's mapping
+} RoadGraph;
+
+// functions
+RoadGraph BuildRoadGraph(const uint8_t *wallDistance, int width, int height);
+bool LoadRoadGraph(RoadGraph *graph, const void *data, size_t size);
+void UnloadRoadGraph(RoadGraph *graph);
+bool IsForwardRoadEdge(const RoadGraph *graph, uint32_t edge);
+uint32_t GetReverseRoadEdge(const RoadGraph *graph, uint32_t edge);
+Vector2 GetRoadEdgePoint(const RoadGraph *graph, uint32_t edge, uint32_t k);
+Vector2 GetRoadPieceHeading(Vector2 from, Vector2 to);
+
+#endif
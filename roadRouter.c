@@ -0,0 +1,596 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "raylib.h"
+#include "raymath.h"
+#include "roadRouter.h"
+#include "jobs.h"
+
+#define NO_EDGE UINT32_MAX
+#define MAX_TABLE_BANDS 64
+
+/*
+Adds an entry to a binary heap (smallest priority on top)
+Parameters: The heap (*queue), pointer to its number of entries (*count) and the entry (item)
+*/
+static void pushQueue(RoadQueueItem *queue, int *count, RoadQueueItem item) {
+    int i = (*count)++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (queue[parent].priority <= item.priority) break;
+        queue[i] = queue[parent];
+        i = parent;
+    }
+    queue[i] = item;
+}
+
+/*
+Removes the top entry of a binary heap
+Parameters: The heap (*queue) and pointer to its number of entries (*count), at least 1
+Returns: The entry with the smallest priority (RoadQueueItem)
+*/
+static RoadQueueItem popQueue(RoadQueueItem *queue, int *count) {
+    RoadQueueItem top = queue[0];
+    RoadQueueItem last = queue[--(*count)];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= *count) break;
+        if (child + 1 < *count && queue[child + 1].priority < queue[child].priority) child++;
+        if (last.priority <= queue[child].priority) break;
+        queue[i] = queue[child];
+        i = child;
+    }
+    queue[i] = last;
+    return top;
+}
+
+/*
+Finds the distance from a set of sources to every node (Dijkstra). Each source starts with its own cost
+Parameters: Pointer to the graph (*graph), the sources (*sources), their costs (*costs) and number (sourceCount),
+distances to fill (*distance) and a heap with room for every edge plus the sources (*queue)
+*/
+static void findDistances(const RoadGraph *graph, const uint32_t *sources, const float *costs, int sourceCount, float *distance, RoadQueueItem *queue) {
+    for (int n = 0; n < graph->nodeCount; n++) distance[n] = INFINITY;
+    int count = 0;
+    for (int i = 0; i < sourceCount; i++) {
+        if (costs[i] >= distance[sources[i]]) continue;
+        distance[sources[i]] = costs[i];
+        pushQueue(queue, &count, (RoadQueueItem){ costs[i], costs[i], sources[i] });
+    }
+
+    while (count > 0) {
+        RoadQueueItem item = popQueue(queue, &count);
+        if (item.cost > distance[item.node]) continue; // A stale entry, the node was reached for less since
+        for (uint32_t e = graph->edgeStart[item.node]; e < graph->edgeStart[item.node + 1]; e++) {
+            uint32_t target = graph->edgeTarget[e];
+            float cost = item.cost + graph->segments[graph->edgeSegment[e]].length;
+            if (cost < distance[target]) {
+                distance[target] = cost;
+                pushQueue(queue, &count, (RoadQueueItem){ cost, cost, target });
+            }
+        }
+    }
+}
+
+/*
+Labels the connected components of the graph, so that searches between them can stop at once
+Parameter: Pointer to the router (*router) with its graph set
+*/
+static void findComponents(RoadRouter *router) {
+    const RoadGraph *graph = &router->graph;
+    uint32_t *stack = malloc((graph->nodeCount + 1) * sizeof(uint32_t));
+    for (int n = 0; n < graph->nodeCount; n++) router->component[n] = NO_EDGE;
+
+    uint32_t components = 0;
+    for (int n = 0; n < graph->nodeCount; n++) {
+        if (router->component[n] != NO_EDGE) continue;
+        int count = 0;
+        router->component[n] = components;
+        stack[count++] = (uint32_t)n;
+        while (count > 0) {
+            uint32_t node = stack[--count];
+            for (uint32_t e = graph->edgeStart[node]; e < graph->edgeStart[node + 1]; e++) {
+                uint32_t target = graph->edgeTarget[e];
+                if (router->component[target] != NO_EDGE) continue;
+                router->component[target] = components;
+                stack[count++] = target;
+            }
+        }
+        components++;
+    }
+    free(stack);
+}
+
+/*
+Picks the landmarks of every connected component (each one the node farthest from those before it, so that they end up
+around the component's edges) and stores the distance from each of them to every node of the component
+Parameter: Pointer to the router (*router) with its graph, components and landmark count set
+*/
+static void pickLandmarks(RoadRouter *router) {
+    const RoadGraph *graph = &router->graph;
+    int nodeCount = graph->nodeCount;
+    int landmarkCount = router->landmarkCount;
+    float *distance = malloc(nodeCount * sizeof(float));
+    float *nearest = malloc(nodeCount * sizeof(float)); // Distance from every node to its nearest landmark so far
+    RoadQueueItem *queue = malloc(((size_t)graph->segmentCount * 2 + 1) * sizeof(RoadQueueItem));
+    const float zero = 0;
+
+    // Components are numbered in the order of their lowest node
+    uint32_t component = 0;
+    for (int seed = 0; seed < nodeCount && landmarkCount > 0; seed++) {
+        if (router->component[seed] != component) continue;
+        uint32_t source = (uint32_t)seed;
+        findDistances(graph, &source, &zero, 1, distance, queue); // The first landmark is the node farthest from an arbitrary one
+        for (int n = seed; n < nodeCount; n++) nearest[n] = distance[n];
+
+        for (int l = 0; l < landmarkCount; l++) {
+            uint32_t landmark = (uint32_t)seed;
+            for (int n = seed; n < nodeCount; n++) {
+                if (router->component[n] == component && nearest[n] > nearest[landmark]) landmark = (uint32_t)n;
+            }
+
+            findDistances(graph, &landmark, &zero, 1, distance, queue);
+            for (int n = seed; n < nodeCount; n++) {
+                if (router->component[n] != component) continue;
+                router->landmarkDistance[(size_t)n * landmarkCount + l] = distance[n];
+                nearest[n] = (l == 0) ? distance[n] : fminf(nearest[n], distance[n]);
+            }
+        }
+        component++;
+    }
+
+    free(queue);
+    free(nearest);
+    free(distance);
+}
+
+/*
+Finds the grid cell of a position, clamped to the grid
+Parameters: Pointer to the router (*router), the position (position) and the cell's coordinates to fill (*cx, *cy)
+*/
+static void findCell(const RoadRouter *router, Vector2 position, int *cx, int *cy) {
+    *cx = (int)Clamp(floorf(position.x / ROUTER_CELL_SIZE), 0, router->gridWidth - 1);
+    *cy = (int)Clamp(floorf(position.y / ROUTER_CELL_SIZE), 0, router->gridHeight - 1);
+}
+
+/*
+Lists every centerline piece in the grid cells its bounding box touches (counting sort into cellStart)
+Parameter: Pointer to the router (*router) with its graph set
+*/
+static void buildGrid(RoadRouter *router) {
+    const RoadGraph *graph = &router->graph;
+    float maxX = 0, maxY = 0;
+    for (int p = 0; p < graph->pointCount; p++) {
+        maxX = fmaxf(maxX, graph->points[p].x);
+        maxY = fmaxf(maxY, graph->points[p].y);
+    }
+    router->gridWidth = (int)(maxX / ROUTER_CELL_SIZE) + 1;
+    router->gridHeight = (int)(maxY / ROUTER_CELL_SIZE) + 1;
+    int cells = router->gridWidth * router->gridHeight;
+    router->cellStart = calloc(cells + 1, sizeof(uint32_t));
+
+    // First count the pieces of every cell, then fill them in
+    uint32_t *fill = NULL;
+    for (int pass = 0; pass < 2; pass++) {
+        for (int s = 0; s < graph->segmentCount; s++) {
+            const RoadSegment *segment = &graph->segments[s];
+            for (uint32_t p = segment->firstPoint; p + 1 < segment->firstPoint + segment->pointCount; p++) {
+                int x0, y0, x1, y1;
+                findCell(router, Vector2Min(graph->points[p], graph->points[p + 1]), &x0, &y0);
+                findCell(router, Vector2Max(graph->points[p], graph->points[p + 1]), &x1, &y1);
+                for (int cy = y0; cy <= y1; cy++) {
+                    for (int cx = x0; cx <= x1; cx++) {
+                        int cell = cy * router->gridWidth + cx;
+                        if (pass == 0) router->cellStart[cell + 1]++;
+                        else router->pieces[fill[cell]++] = (RoadPiece){ (uint32_t)s, p };
+                    }
+                }
+            }
+        }
+
+        if (pass == 0) {
+            for (int c = 0; c < cells; c++) router->cellStart[c + 1] += router->cellStart[c];
+            router->pieces = malloc((router->cellStart[cells] + 1) * sizeof(RoadPiece));
+            fill = malloc((cells + 1) * sizeof(uint32_t));
+            memcpy(fill, router->cellStart, cells * sizeof(uint32_t));
+        }
+    }
+    free(fill);
+}
+
+/*
+Prepares a road graph for path queries: labels its components, picks the landmarks of every component and measures
+the distance from each of them to every node of its component, and grids the centerlines
+Parameters: The graph (graph), which must outlive the router, and the number of landmarks (landmarkCount, up to ROUTER_MAX_LANDMARKS).
+With no landmarks, searches fall back to the straight-line estimate
+Returns: The router (RoadRouter). Must be freed with UnloadRoadRouter
+*/
+RoadRouter BuildRoadRouter(RoadGraph graph, int landmarkCount) {
+    RoadRouter router = {0};
+    router.graph = graph;
+    if (graph.nodeCount == 0) return router;
+
+    if (landmarkCount > ROUTER_MAX_LANDMARKS) landmarkCount = ROUTER_MAX_LANDMARKS;
+    if (landmarkCount > graph.nodeCount) landmarkCount = graph.nodeCount;
+    if (landmarkCount < 0) landmarkCount = 0;
+    router.landmarkCount = landmarkCount;
+    router.component = malloc(graph.nodeCount * sizeof(uint32_t));
+    router.landmarkDistance = malloc(((size_t)graph.nodeCount * landmarkCount + 1) * sizeof(float));
+
+    findComponents(&router);
+    pickLandmarks(&router);
+    buildGrid(&router);
+    return router;
+}
+
+/*
+Frees a router (but not its graph)
+Parameter: Pointer to the router (*router)
+*/
+void UnloadRoadRouter(RoadRouter *router) {
+    free(router->component);
+    free(router->landmarkDistance);
+    free(router->cellStart);
+    free(router->pieces);
+    *router = (RoadRouter){0};
+}
+
+/*
+Finds the point of the road network nearest to a position, if there is one within a distance. Searches the grid cells in growing rings
+around the position, until no unvisited cell can hold anything closer (or anything within the distance)
+Parameters: Pointer to the router (*router), the position (position), the largest distance to look at (maxDistance) and the point to fill (*road)
+Returns: true if a road was found. Otherwise, false
+*/
+bool FindNearestRoadWithin(const RoadRouter *router, Vector2 position, float maxDistance, RoadPosition *road) {
+    const RoadGraph *graph = &router->graph;
+    if (graph->segmentCount == 0) return false;
+
+    int cx, cy;
+    findCell(router, position, &cx, &cy);
+    int rings = (router->gridWidth > router->gridHeight) ? router->gridWidth : router->gridHeight;
+    float best = INFINITY;
+    RoadPiece bestPiece = {0};
+    float bestT = 0;
+
+    for (int ring = 0; ring <= rings; ring++) {
+        for (int y = cy - ring; y <= cy + ring; y++) {
+            if (y < 0 || y >= router->gridHeight) continue;
+            int step = (y == cy - ring || y == cy + ring) ? 1 : 2 * ring; // Only the ring's border
+            for (int x = cx - ring; x <= cx + ring; x += step) {
+                if (x < 0 || x >= router->gridWidth) continue;
+                int cell = y * router->gridWidth + x;
+                for (uint32_t i = router->cellStart[cell]; i < router->cellStart[cell + 1]; i++) {
+                    RoadPiece piece = router->pieces[i];
+                    Vector2 a = graph->points[piece.point], b = graph->points[piece.point + 1];
+                    Vector2 ab = Vector2Subtract(b, a);
+                    float lengthSqr = Vector2LengthSqr(ab);
+                    float t = (lengthSqr > 0) ? Clamp(Vector2DotProduct(Vector2Subtract(position, a), ab) / lengthSqr, 0, 1) : 0;
+                    float distance = Vector2Distance(position, Vector2Add(a, Vector2Scale(ab, t)));
+                    if (distance < best) {
+                        best = distance;
+                        bestPiece = piece;
+                        bestT = t;
+                    }
+                }
+            }
+        }
+        if (best <= ring * ROUTER_CELL_SIZE || ring * ROUTER_CELL_SIZE >= maxDistance) break; // Cells outside this ring are at least that far
+    }
+    if (best > maxDistance) return false;
+
+    const RoadSegment *segment = &graph->segments[bestPiece.segment];
+    float offset = 0;
+    for (uint32_t p = segment->firstPoint; p < bestPiece.point; p++) offset += Vector2Distance(graph->points[p], graph->points[p + 1]);
+    Vector2 a = graph->points[bestPiece.point], b = graph->points[bestPiece.point + 1];
+
+    road->segment = bestPiece.segment;
+    road->offset = offset + bestT * Vector2Distance(a, b);
+    road->point = Vector2Lerp(a, b, bestT);
+    road->distance = best;
+    return true;
+}
+
+/*
+Finds the point of the road network nearest to a position, however far
+Parameters: Pointer to the router (*router), the position (position) and the point to fill (*road)
+Returns: true if the network has any road. Otherwise, false
+*/
+bool FindNearestRoad(const RoadRouter *router, Vector2 position, RoadPosition *road) {
+    return FindNearestRoadWithin(router, position, INFINITY, road);
+}
+
+/*
+Allocates the scratch memory of path queries on a router's graph
+Parameter: Pointer to the router (*router)
+Returns: The search (RoadSearch). Must be freed with UnloadRoadSearch
+*/
+RoadSearch LoadRoadSearch(const RoadRouter *router) {
+    const RoadGraph *graph = &router->graph;
+    RoadSearch search = {0};
+    search.nodeCount = graph->nodeCount;
+    search.cost = malloc((graph->nodeCount + 1) * sizeof(float));
+    search.parentEdge = malloc((graph->nodeCount + 1) * sizeof(uint32_t));
+    search.stamp = calloc(graph->nodeCount + 1, sizeof(uint32_t));
+    search.closed = malloc((graph->nodeCount + 1) * sizeof(bool));
+    search.queueCapacity = graph->segmentCount * 2 + 2; // Every edge pushes at most once, plus both ends of the start
+    search.queue = malloc(search.queueCapacity * sizeof(RoadQueueItem));
+    search.path = malloc((graph->nodeCount + 1) * sizeof(uint32_t)); // A shortest path visits every node at most once
+    return search;
+}
+
+/*
+Frees the scratch memory of path queries
+Parameter: Pointer to the search (*search)
+*/
+void UnloadRoadSearch(RoadSearch *search) {
+    free(search->cost);
+    free(search->parentEdge);
+    free(search->stamp);
+    free(search->closed);
+    free(search->queue);
+    free(search->path);
+    *search = (RoadSearch){0};
+}
+
+/*
+Estimates the distance left from a node to the goal, never more than the real one: the larger of the straight-line distance
+and the landmarks' bound |d(L, goal) - d(L, node)| (triangle inequality)
+Parameters: Pointer to the router (*router), the node (node), each landmark's distance to the goal (*goalDistance) and goal's point (goal)
+Returns: The estimate in pixels (float)
+*/
+static float estimateDistance(const RoadRouter *router, uint32_t node, const float *goalDistance, Vector2 goal) {
+    float estimate = Vector2Distance(router->graph.nodes[node], goal);
+    const float *distance = router->landmarkDistance + (size_t)node * router->landmarkCount;
+    for (int l = 0; l < router->landmarkCount; l++) {
+        float bound = fabsf(goalDistance[l] - distance[l]);
+        if (bound > estimate) estimate = bound;
+    }
+    return estimate;
+}
+
+/*
+Offers a node a new cost, if it is the best one so far
+Parameters: Pointer to the router (*router), the search (*search), the node (node), its cost (cost), the edge that reached it (edge),
+each landmark's distance to the goal (*goalDistance) and goal's point (goal)
+*/
+static void relaxNode(const RoadRouter *router, RoadSearch *search, uint32_t node, float cost, uint32_t edge, const float *goalDistance, Vector2 goal) {
+    if (search->stamp[node] == search->search && (cost >= search->cost[node] || search->closed[node])) return;
+    search->stamp[node] = search->search;
+    search->closed[node] = false;
+    search->cost[node] = cost;
+    search->parentEdge[node] = edge;
+    pushQueue(search->queue, &search->queueCount, (RoadQueueItem){ cost + estimateDistance(router, node, goalDistance, goal), cost, node });
+}
+
+/*
+Finds the shortest way along the roads between two positions (A* with landmark estimates, ALT). Both positions join
+the network at its nearest point. The path's edges are left in search->path
+Parameters: Pointer to the router (*router), the search's memory (*search) and the two positions (from, to)
+Returns: Length of the way in pixels, including the straight legs to and from the network, or -1 if the positions aren't connected
+*/
+float FindRoadPath(const RoadRouter *router, RoadSearch *search, Vector2 from, Vector2 to) {
+    const RoadGraph *graph = &router->graph;
+    search->pathCount = 0;
+    search->settled = 0;
+    if (!FindNearestRoad(router, from, &search->start) || !FindNearestRoad(router, to, &search->goal)) return -1.0f;
+
+    const RoadSegment *startSegment = &graph->segments[search->start.segment];
+    const RoadSegment *goalSegment = &graph->segments[search->goal.segment];
+    if (router->component[startSegment->nodes[0]] != router->component[goalSegment->nodes[0]]) return -1.0f;
+
+    // The goal lies on a segment, so a landmark reaches it through either end
+    float goalDistance[ROUTER_MAX_LANDMARKS];
+    for (int l = 0; l < router->landmarkCount; l++) {
+        const float *first = router->landmarkDistance + (size_t)goalSegment->nodes[0] * router->landmarkCount;
+        const float *second = router->landmarkDistance + (size_t)goalSegment->nodes[1] * router->landmarkCount;
+        goalDistance[l] = fminf(first[l] + search->goal.offset, second[l] + goalSegment->length - search->goal.offset);
+    }
+
+    if (++search->search == 0) { // Wrapped around, old stamps could look current
+        memset(search->stamp, 0, search->nodeCount * sizeof(uint32_t));
+        search->search = 1;
+    }
+    search->queueCount = 0;
+
+    float best = INFINITY;
+    uint32_t bestNode = NO_EDGE; // Last node before the goal's segment, none if the way stays on the start's segment
+    if (search->start.segment == search->goal.segment) best = fabsf(search->start.offset - search->goal.offset);
+    Vector2 goal = search->goal.point;
+    relaxNode(router, search, startSegment->nodes[0], search->start.offset, NO_EDGE, goalDistance, goal);
+    relaxNode(router, search, startSegment->nodes[1], startSegment->length - search->start.offset, NO_EDGE, goalDistance, goal);
+
+    while (search->queueCount > 0) {
+        RoadQueueItem item = popQueue(search->queue, &search->queueCount);
+        if (item.priority >= best) break; // Nothing left can beat the best way found
+        if (item.cost > search->cost[item.node] || search->closed[item.node]) continue;
+        search->closed[item.node] = true; // Never reopened, so that every edge is pushed at most once
+        search->settled++;
+
+        if (item.node == goalSegment->nodes[0] && item.cost + search->goal.offset < best) {
+            best = item.cost + search->goal.offset;
+            bestNode = item.node;
+        }
+        if (item.node == goalSegment->nodes[1] && item.cost + goalSegment->length - search->goal.offset < best) {
+            best = item.cost + goalSegment->length - search->goal.offset;
+            bestNode = item.node;
+        }
+
+        for (uint32_t e = graph->edgeStart[item.node]; e < graph->edgeStart[item.node + 1]; e++) {
+            relaxNode(router, search, graph->edgeTarget[e], item.cost + graph->segments[graph->edgeSegment[e]].length, e, goalDistance, goal);
+        }
+    }
+    if (isinf(best)) return -1.0f;
+
+    // Walk the parents back from the goal's side, then flip the edges into travel order
+    for (uint32_t node = bestNode; node != NO_EDGE && search->parentEdge[node] != NO_EDGE;) {
+        uint32_t edge = search->parentEdge[node];
+        const RoadSegment *segment = &graph->segments[graph->edgeSegment[edge]];
+        search->path[search->pathCount++] = edge;
+        node = (segment->nodes[0] == node) ? segment->nodes[1] : segment->nodes[0];
+    }
+    for (int i = 0; i < search->pathCount / 2; i++) {
+        uint32_t swap = search->path[i];
+        search->path[i] = search->path[search->pathCount - 1 - i];
+        search->path[search->pathCount - 1 - i] = swap;
+    }
+
+    return search->start.distance + best + search->goal.distance;
+}
+
+// A band of rows of a distance table, filled by one job
+typedef struct {
+    const RoadRouter *router;
+    const RoadPosition *from; // Every row's position on the network (segment == UINT32_MAX if there's no road)
+    const RoadPosition *to;
+    int toCount;
+    float *table;
+    int first;
+    int last;
+} DistanceRows;
+
+/*
+Job: fills a band of rows of a distance table, one Dijkstra per row that starts from both ends of the row's segment
+Parameter: Pointer to the band (DistanceRows *)
+*/
+static void findDistanceRows(void *data) {
+    DistanceRows *rows = data;
+    const RoadGraph *graph = &rows->router->graph;
+    float *distance = malloc((graph->nodeCount + 1) * sizeof(float));
+    RoadQueueItem *queue = malloc(((size_t)graph->segmentCount * 2 + 2) * sizeof(RoadQueueItem));
+
+    for (int r = rows->first; r < rows->last; r++) {
+        const RoadPosition *from = &rows->from[r];
+        float *row = rows->table + (size_t)r * rows->toCount;
+        if (from->segment == NO_EDGE) {
+            for (int t = 0; t < rows->toCount; t++) row[t] = -1.0f;
+            continue;
+        }
+
+        const RoadSegment *segment = &graph->segments[from->segment];
+        float costs[2] = { from->offset, segment->length - from->offset };
+        findDistances(graph, segment->nodes, costs, 2, distance, queue);
+
+        for (int t = 0; t < rows->toCount; t++) {
+            const RoadPosition *to = &rows->to[t];
+            if (to->segment == NO_EDGE) {
+                row[t] = -1.0f;
+                continue;
+            }
+            const RoadSegment *target = &graph->segments[to->segment];
+            float best = fminf(distance[target->nodes[0]] + to->offset, distance[target->nodes[1]] + target->length - to->offset);
+            if (to->segment == from->segment) best = fminf(best, fabsf(to->offset - from->offset));
+            row[t] = isinf(best) ? -1.0f : from->distance + best + to->distance;
+        }
+    }
+
+    free(queue);
+    free(distance);
+}
+
+/*
+Finds the road distance from every position of one set to every position of another, in parallel jobs (a few rows each)
+Parameters: Pointer to the router (*router), the first set (*from, fromCount), the second set (*to, toCount)
+and the table to fill (*table, fromCount x toCount): the distance from from[i] to to[j] at [i * toCount + j],
+including the straight legs to and from the network, or -1 if they aren't connected
+*/
+void FindRoadDistanceTable(const RoadRouter *router, const Vector2 *from, int fromCount, const Vector2 *to, int toCount, float *table) {
+    RoadPosition *roads = malloc(((size_t)fromCount + toCount + 1) * sizeof(RoadPosition));
+    for (int i = 0; i < fromCount + toCount; i++) {
+        Vector2 position = (i < fromCount) ? from[i] : to[i - fromCount];
+        if (!FindNearestRoad(router, position, &roads[i])) roads[i].segment = NO_EDGE;
+    }
+
+    int bandCount = (GetJobWorkerCount() + 1) * 4;
+    if (bandCount > MAX_TABLE_BANDS) bandCount = MAX_TABLE_BANDS;
+    if (bandCount > fromCount) bandCount = fromCount;
+
+    DistanceRows bands[MAX_TABLE_BANDS];
+    Job jobs[MAX_TABLE_BANDS];
+    for (int b = 0; b < bandCount; b++) {
+        bands[b] = (DistanceRows){ router, roads, roads + fromCount, toCount, table, fromCount * b / bandCount, fromCount * (b + 1) / bandCount };
+        InitJob(&jobs[b], "distance table", findDistanceRows, &bands[b]);
+        SubmitJob(&jobs[b]);
+    }
+    for (int b = 0; b < bandCount; b++) WaitForJob(&jobs[b]);
+    free(roads);
+}
+
+// A band of places whose distances one job measures
+typedef struct {
+    const RoadRouter *router;
+    RoadTargets *targets;
+    int first;
+    int last;
+} TargetBand;
+
+/*
+Job: measures the distance from every node to a band of places, one Dijkstra per place that starts from both ends of its segment
+Parameter: Pointer to the band (TargetBand *)
+*/
+static void findTargetDistances(void *data) {
+    TargetBand *band = data;
+    const RoadGraph *graph = &band->router->graph;
+    RoadQueueItem *queue = malloc(((size_t)graph->segmentCount * 2 + 2) * sizeof(RoadQueueItem));
+
+    for (int p = band->first; p < band->last; p++) {
+        const RoadPosition *road = &band->targets->roads[p];
+        const RoadSegment *segment = &graph->segments[road->segment];
+        float costs[2] = { road->offset, segment->length - road->offset };
+        findDistances(graph, segment->nodes, costs, 2, band->targets->nodeDistance + (size_t)p * graph->nodeCount, queue);
+    }
+    free(queue);
+}
+
+/*
+Snaps a set of places to the road network and measures the distance from every node to each of them, in parallel jobs (a few places each).
+Roads run both ways at the same length, so the distance from a place is also the distance to it
+Parameters: Pointer to the router (*router) and the places (*positions, count)
+Returns: The places that snapped to the network, with their distances (RoadTargets). Must be freed with UnloadRoadTargets
+*/
+RoadTargets BuildRoadTargets(const RoadRouter *router, const Vector2 *positions, int count) {
+    const RoadGraph *graph = &router->graph;
+    RoadTargets targets = {0};
+    targets.roads = malloc(((size_t)count + 1) * sizeof(RoadPosition));
+    for (int i = 0; i < count; i++) {
+        if (FindNearestRoad(router, positions[i], &targets.roads[targets.count])) targets.count++;
+    }
+    targets.nodeDistance = malloc(((size_t)targets.count * graph->nodeCount + 1) * sizeof(float));
+
+    int bandCount = (GetJobWorkerCount() + 1) * 4;
+    if (bandCount > MAX_TABLE_BANDS) bandCount = MAX_TABLE_BANDS;
+    if (bandCount > targets.count) bandCount = targets.count;
+
+    TargetBand bands[MAX_TABLE_BANDS];
+    Job jobs[MAX_TABLE_BANDS];
+    for (int b = 0; b < bandCount; b++) {
+        bands[b] = (TargetBand){ router, &targets, targets.count * b / bandCount, targets.count * (b + 1) / bandCount };
+        InitJob(&jobs[b], "road targets", findTargetDistances, &bands[b]);
+        SubmitJob(&jobs[b]);
+    }
+    for (int b = 0; b < bandCount; b++) WaitForJob(&jobs[b]);
+    return targets;
+}
+
+/*
+Frees a set of places and their distances
+Parameter: Pointer to the places (*targets)
+*/
+void UnloadRoadTargets(RoadTargets *targets) {
+    free(targets->roads);
+    free(targets->nodeDistance);
+    *targets = (RoadTargets){0};
+}
@@ -0,0 +1,97 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+
+#ifndef ROADROUTER_H
+#define ROADROUTER_H
+
+#include <stdint.h>
+#include "raylib.h"
+#include "roadGraph.h"
+
+#define ROUTER_LANDMARKS 8      // Landmarks the game's router uses
+#define ROUTER_MAX_LANDMARKS 16
+#define ROUTER_CELL_SIZE 32     // Pixels per cell of the grid that finds the road nearest to a position
+
+// A point on the road network
+typedef struct {
+    uint32_t segment;
+    float offset;   // Along the segment's centerline, from its nodes[0]
+    Vector2 point;  // The point itself
+    float distance; // Straight distance from the position that was looked up
+} RoadPosition;
+
+// One straight piece of a centerline (points[point] to points[point + 1]), listed in every cell its bounds touch
+typedef struct {
+    uint32_t segment;
+    uint32_t point;
+} RoadPiece;
+
+// Everything that path queries need besides the graph itself: landmark distances (ALT) for the A* estimate
+// and a grid of centerline pieces for finding the road nearest to a position. Read only, shared by every search
+typedef struct {
+    RoadGraph graph;          // Copy of the graph's header, its arrays are shared (and freed by the graph's owner)
+    uint32_t *component;      // Connected component of every node
+    int landmarkCount;        // Landmarks per component
+    float *landmarkDistance;  // Distance from landmark l of node n's component to node n, at [n * landmarkCount + l]
+    int gridWidth;
+    int gridHeight;
+    uint32_t *cellStart;      // The pieces of cell c are pieces[cellStart[c]] .. pieces[cellStart[c + 1] - 1]
+    RoadPiece *pieces;
+} RoadRouter;
+
+// Places many vehicles head for (restaurants and houses), with the distance from every node to each of them,
+// so that picking the next road towards one costs a lookup per road
+typedef struct {
+    int count;            // Places that snapped to the network, the others are left out
+    RoadPosition *roads;  // Every place's point on the network
+    float *nodeDistance;  // Road distance from node n to place p, at [p * nodeCount + n] (INFINITY if not connected)
+} RoadTargets;
+
+// Priority queue entry of a search
+typedef struct {
+    float priority; // Cost so far plus the estimate of the rest
+    float cost;
+    uint32_t node;
+} RoadQueueItem;
+
+// Scratch memory of path queries, plus the last path found. One per thread
+typedef struct {
+    int nodeCount;
+    float *cost;          // Best known distance from the start to every node
+    uint32_t *parentEdge; // Edge that reached every node on its best path
+    bool *closed;         // Set once a node is settled
+    uint32_t *stamp;      // cost, parentEdge and closed of node n are only valid if stamp[n] == search
+    uint32_t search;      // Number of the current search, so that nothing needs clearing between searches
+    RoadQueueItem *queue; // Binary heap
+    int queueCount;
+    int queueCapacity;
+    uint32_t *path;       // Edges of the last path (indices of edgeTarget), from the start's side
+    int pathCount;
+    RoadPosition start;   // Ends of the last path on the network
+    RoadPosition goal;
+    int settled;          // Nodes the last search settled, a measure of its work
+} RoadSearch;
+
+// functions
+RoadRouter BuildRoadRouter(RoadGraph graph, int landmarkCount);
+void UnloadRoadRouter(RoadRouter *router);
+bool FindNearestRoad(const RoadRouter *router, Vector2 position, RoadPosition *road);
+bool FindNearestRoadWithin(const RoadRouter *router, Vector2 position, float maxDistance, RoadPosition *road);
+RoadSearch LoadRoadSearch(const RoadRouter *router);
+void UnloadRoadSearch(RoadSearch *search);
+float FindRoadPath(const RoadRouter *router, RoadSearch *search, Vector2 from, Vector2 to);
+void FindRoadDistanceTable(const RoadRouter *router, const Vector2 *from, int fromCount, const Vector2 *to, int toCount, float *table);
+RoadTargets BuildRoadTargets(const RoadRouter *router, const Vector2 *positions, int count);
+void UnloadRoadTargets(RoadTargets *targets);
+
+#endif
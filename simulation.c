@@ -0,0 +1,132 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+
+#include "raylib.h"
+#include "simulation.h"
+#include "profiler.h"
+
+/*
+Starts a new session: full time, no orders completed and the player at the start
+Parameters: Pointer to the simulation (*sim), player's starting position (start) and size (bikeSize)
+*/
+void ResetSimulation(Simulation *sim, Vector2 start, float bikeSize) {
+    OrderStatusMessage message = sim->message; // A message of the last session may still be on screen
+    *sim = (Simulation){ 0 };
+    sim->bike = (Rectangle){ start.x, start.y, bikeSize, bikeSize };
+    sim->previousBikePos = start;
+    sim->globalTimer = GAME_DURATION;
+    sim->order = CreateNewOrder();
+    sim->message = message;
+}
+
+/*
+Moves the player one tick towards a direction, unless a wall or a vehicle is in the way
+Parameters: Pointer to the simulation (*sim), direction (dx, dy), rotation it gives the player (rotation),
+point of the hitbox that leads the move (lead), pointer to the vehicle store (*vehicles) and pointer to map's data (*map)
+*/
+static void movePlayer(Simulation *sim, float dx, float dy, int rotation, Vector2 lead, const VehicleStore *vehicles, const MapData *map) {
+    Rectangle futurePos = sim->bike;
+    futurePos.x += dx;
+    futurePos.y += dy;
+    bool hitCar = checkCollisionWithVehicles(futurePos, vehicles, true);
+    if (!willTouchBorder(map, lead) && !hitCar) {
+        sim->rotation = rotation;
+        sim->bike.x += dx;
+        sim->bike.y += dy;
+        sim->isRespawning = false;
+    }
+}
+
+/*
+Advances the session by one tick (SIMULATION_TICK seconds): timers, traffic, orders, player's movement and the stuck/respawn logic
+Parameters: Pointer to the simulation (*sim), keys held (input), pointer to the vehicle store (*vehicles) and pointer to map's data (*map)
+*/
+void StepSimulation(Simulation *sim, PlayerInput input, VehicleStore *vehicles, const MapData *map) {
+    sim->ticks++;
+    sim->previousBikePos = (Vector2){ sim->bike.x, sim->bike.y };
+
+    sim->globalTimer -= SIMULATION_TICK;
+    if (sim->globalTimer <= 0) {
+        sim->globalTimer = 0;
+        sim->isOver = true;
+    }
+
+    // 1. Traffic & Orders
+    ProfileBegin(PROFILE_TRAFFIC);
+    updateTraffic(vehicles, map, (Vector2){ sim->bike.x, sim->bike.y });
+    ProfileEnd(PROFILE_TRAFFIC);
+    ProfileBegin(PROFILE_ORDERS);
+    updateOrder(&sim->order, (Vector2){ sim->bike.x, sim->bike.y }, SIMULATION_TICK, &sim->count, &sim->totalMoney,
+                houses, houseCount, &sim->message, &sim->lastReward);
+    ProfileEnd(PROFILE_ORDERS);
+
+    // 2. Movement & Physics
+    ProfileBegin(PROFILE_MOVEMENT);
+    float horizontalOffset, verticalOffset;
+    if (sim->rotation == 90 || sim->rotation == 270) {
+        horizontalOffset = sim->bike.height / 2.0f;
+        verticalOffset = sim->bike.width / 3.5f;
+    } else {
+        horizontalOffset = sim->bike.width / 3.5f;
+        verticalOffset = sim->bike.height / 2.0f;
+    }
+
+    const Vector2 collisionPoints[4] = {
+        {sim->bike.x, sim->bike.y - verticalOffset - 1},
+        {sim->bike.x + horizontalOffset + 1, sim->bike.y},
+        {sim->bike.x, sim->bike.y + verticalOffset + 1},
+        {sim->bike.x - horizontalOffset - 1, sim->bike.y}
+    };
+
+    float step = PLAYER_SPEED * SIMULATION_TICK;
+    if (input.forward) movePlayer(sim, 0, -step, 0, collisionPoints[0], vehicles, map);
+    if (input.backward) movePlayer(sim, 0, step, 180, collisionPoints[2], vehicles, map);
+    if (input.left) movePlayer(sim, -step, 0, 270, collisionPoints[3], vehicles, map);
+    if (input.right) movePlayer(sim, step, 0, 90, collisionPoints[1], vehicles, map);
+
+    // 3. Collision / Stuck Logic
+    sim->isColliding = checkCollisionWithVehicles(sim->bike, vehicles, false);
+    if (sim->isColliding) {
+        if (!sim->isRespawning) sim->collisionDuration += SIMULATION_TICK;
+    } else {
+        sim->collisionDuration = 0.0f;
+    }
+
+    if (sim->collisionDuration > 1.5f && !sim->isRespawning) {
+        sim->isRespawning = true;
+        sim->respawnTimer = 3.0f;
+    }
+
+    if (sim->isRespawning) {
+        sim->respawnTimer -= SIMULATION_TICK;
+        if (sim->respawnTimer <= 0) {
+            Vector2 newPos = GetRandomValidPosition(map, vehicles);
+            sim->bike.x = newPos.x;
+            sim->bike.y = newPos.y;
+            sim->previousBikePos = newPos; // A jump, not a move
+            sim->isRespawning = false;
+            sim->collisionDuration = 0.0f;
+        }
+    }
+    ProfileEnd(PROFILE_MOVEMENT);
+}
+
+/*
+Finds where to draw the player between the last two ticks
+Parameters: Pointer to the simulation (*sim) and fraction of a tick since the last one (alpha)
+Returns: Player's position (Vector2)
+*/
+Vector2 GetInterpolatedBikePosition(const Simulation *sim, float alpha) {
+    return (Vector2){ sim->previousBikePos.x + (sim->bike.x - sim->previousBikePos.x) * alpha,
+                      sim->previousBikePos.y + (sim->bike.y - sim->previousBikePos.y) * alpha };
+}
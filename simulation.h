@@ -0,0 +1,61 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <stdint.h>
+#include "raylib.h"
+#include "helpers.h"
+
+// The game advances in fixed ticks, whatever the display's refresh rate. Rendering interpolates between the last two ticks
+#define SIMULATION_RATE 120 // Ticks per second
+#define SIMULATION_TICK (1.0f / SIMULATION_RATE)
+#define MAX_TICKS_PER_FRAME 12 // After a longer stall the game slows down instead of trying to catch up
+#define PLAYER_SPEED 120.0f // Pixels per second
+#define PLAYER_SIZE 20 // Hitbox (and drawn size) of the bike, in pixels
+#define GAME_DURATION 240.0f // 4 Minutes in seconds
+
+// Keys held during a tick
+typedef struct {
+    bool forward;
+    bool backward;
+    bool left;
+    bool right;
+} PlayerInput;
+
+// Everything a session of Gameplay changes, apart from the traffic
+typedef struct {
+    Rectangle bike;          // Center and size of the player
+    Vector2 previousBikePos; // Center before the last tick, for render interpolation
+    int rotation;
+    float globalTimer;       // Time left in the session
+    Order order;
+    int count;               // Number of orders completed
+    float totalMoney;
+    float lastReward;
+    OrderStatusMessage message;
+    float collisionDuration; // Time spent touching a vehicle
+    float respawnTimer;
+    bool isRespawning;
+    bool isColliding;        // Touching a vehicle after the last tick (the horn sounds)
+    bool isOver;             // The session's time ran out
+    uint64_t ticks;
+} Simulation;
+
+// functions
+void ResetSimulation(Simulation *sim, Vector2 start, float bikeSize);
+void StepSimulation(Simulation *sim, PlayerInput input, VehicleStore *vehicles, const MapData *map);
+Vector2 GetInterpolatedBikePosition(const Simulation *sim, float alpha);
+
+#endif
@@ -0,0 +1,1030 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "raylib.h"
+#include "vehicles.h"
+#include "jobs.h"
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+// --- TRAFFIC CONSTANTS ---
+const float RESTEER_LOOK_AHEAD = 10.0f; // How far ahead a new heading must be clear
+const float FOLLOW_GAP = 3.0f;          // Bumper to bumper distance kept behind the vehicle in front
+const int GRIDLOCK_TICKS = 120;         // Ticks (1 s at 120 Hz) a vehicle waits behind another before it turns away
+const int SORT_INTERVAL = 64;           // Steps between two sorts of the arrays by grid cell
+const int TRAFFIC_TILE_MIN_VEHICLES = 2048; // Smaller tiles cost more to schedule than they save
+const float ROUTE_JOIN_DISTANCE = 16.0f; // Farthest a vehicle may be from a centerline to join it (farther ones are in a spur the network leaves out)
+const float ROUTE_REACHED = 0.01f;      // Distance under which a turning point counts as reached
+const int ROUTE_MAX_ADVANCES = 4;       // Legs of its lane a vehicle may pass in one step
+const int TRIP_MIN_INTERSECTIONS = 3;   // Intersections a vehicle drives towards one destination before drawing another
+const int TRIP_MAX_INTERSECTIONS = 12;
+
+// Footprints (car/police, truck), same as getVehicleSize
+static const float HALF_WIDTH[2] = { 4.0f, 5.5f };
+static const float HALF_LENGTH[2] = { 6.5f, 11.0f };
+
+/*
+Resizes every array of the store, keeping its contents
+Parameters: Pointer to the store (*store) and new capacity (capacity)
+Returns: true on success. Otherwise (out of memory), false and the store is unchanged
+*/
+static bool reserveVehicles(VehicleStore *store, int capacity) {
+    void **arrays[] = { (void **)&store->x, (void **)&store->y, (void **)&store->dirX, (void **)&store->dirY, (void **)&store->speed,
+                        (void **)&store->type, (void **)&store->pose, (void **)&store->color, (void **)&store->nextX, (void **)&store->nextY, (void **)&store->nextDirX, (void **)&store->nextDirY,
+                        (void **)&store->blockedTicks, (void **)&store->random,
+                        (void **)&store->edge, (void **)&store->nextEdge, (void **)&store->waypoint, (void **)&store->destination, (void **)&store->tripLeft,
+                        (void **)&store->slotOf, (void **)&store->slots, (void **)&store->cell, (void **)&store->cellNext, (void **)&store->cellPrev };
+    const size_t sizes[] = { sizeof(float), sizeof(float), sizeof(float), sizeof(float), sizeof(float),
+                             sizeof(uint8_t), sizeof(uint8_t), sizeof(Color), sizeof(float), sizeof(float), sizeof(float), sizeof(float),
+                             sizeof(uint16_t), sizeof(uint32_t),
+                             sizeof(uint32_t), sizeof(uint32_t), sizeof(uint32_t), sizeof(uint32_t), sizeof(uint8_t),
+                             sizeof(uint32_t), sizeof(VehicleSlot), sizeof(int32_t), sizeof(int32_t), sizeof(int32_t) };
+    const int arrayCount = sizeof(sizes) / sizeof(sizes[0]);
+
+    // Arrays that were already moved stay bigger on failure, which is harmless
+    for (int a = 0; a < arrayCount; a++) {
+        void *resized = realloc(*arrays[a], (size_t)capacity * sizes[a]);
+        if (resized == NULL) return false;
+        *arrays[a] = resized;
+    }
+    store->capacity = capacity;
+    return true;
+}
+
+/*
+Creates an empty vehicle store
+Parameters: Number of vehicles to make room for (capacity), the store grows past it when needed,
+and dimensions of the map the vehicles drive on (worldWidth, worldHeight)
+Returns: The store (VehicleStore). Must be freed with UnloadVehicleStore
+*/
+VehicleStore LoadVehicleStore(int capacity, int worldWidth, int worldHeight) {
+    VehicleStore store = {0};
+    store.freeSlot = -1;
+    reserveVehicles(&store, (capacity > 0) ? capacity : 1);
+
+    store.grid.columns = (worldWidth + VEHICLE_GRID_CELL_SIZE - 1) / VEHICLE_GRID_CELL_SIZE;
+    store.grid.rows = (worldHeight + VEHICLE_GRID_CELL_SIZE - 1) / VEHICLE_GRID_CELL_SIZE;
+    if (store.grid.columns < 1) store.grid.columns = 1;
+    if (store.grid.rows < 1) store.grid.rows = 1;
+    store.grid.head = malloc((size_t)store.grid.columns * store.grid.rows * sizeof(int32_t));
+    for (int c = 0; c < store.grid.columns * store.grid.rows; c++) store.grid.head[c] = -1;
+    return store;
+}
+
+/*
+Frees the vehicle store
+Parameter: Pointer to the store (*store)
+*/
+void UnloadVehicleStore(VehicleStore *store) {
+    free(store->x);
+    free(store->y);
+    free(store->dirX);
+    free(store->dirY);
+    free(store->speed);
+    free(store->type);
+    free(store->pose);
+    free(store->color);
+    free(store->nextX);
+    free(store->nextY);
+    free(store->nextDirX);
+    free(store->nextDirY);
+    free(store->blockedTicks);
+    free(store->random);
+    free(store->edge);
+    free(store->nextEdge);
+    free(store->waypoint);
+    free(store->destination);
+    free(store->tripLeft);
+    free(store->slotOf);
+    free(store->slots);
+    free(store->cell);
+    free(store->cellNext);
+    free(store->cellPrev);
+    free(store->grid.head);
+    *store = (VehicleStore){0};
+}
+
+/*
+Finds the pose mask that matches a vehicle's footprint
+Parameters: Type of vehicle (type) and vehicle's rotation (rotation)
+Returns: The pose mask (PoseMask)
+*/
+PoseMask getVehiclePose(TYPE_OF_VEHICLE type, int rotation) {
+    bool horizontal = (rotation == 90 || rotation == 270);
+    if (type == TRUCK) return horizontal ? POSE_TRUCK_HORIZONTAL : POSE_TRUCK_VERTICAL;
+    return horizontal ? POSE_CAR_HORIZONTAL : POSE_CAR_VERTICAL;
+}
+
+/*
+Same as getVehiclePose, for a heading vector
+Parameters: Type of vehicle (type) and heading (dirX, dirY)
+Returns: The pose mask (PoseMask)
+*/
+static PoseMask headingPose(TYPE_OF_VEHICLE type, float dirX, float dirY) {
+    return getVehiclePose(type, (fabsf(dirX) > fabsf(dirY)) ? 90 : 0);
+}
+
+/*
+Finds a grid column or row. Positions off the map go to the nearest border cell
+Parameters: Coordinate (v) and number of columns or rows (count)
+Returns: Column or row (int)
+*/
+static inline int gridIndex(float v, int count) {
+    int index = (int)(v * (1.0f / VEHICLE_GRID_CELL_SIZE));
+    if (v < 0 || index < 0) return 0;
+    return (index >= count) ? count - 1 : index;
+}
+
+/*
+Finds the grid cell of a position
+Parameters: Pointer to the grid (*grid) and position's coordinates (x, y)
+Returns: Cell's index (int)
+*/
+static inline int32_t gridCell(const VehicleGrid *grid, float x, float y) {
+    return gridIndex(y, grid->rows) * grid->columns + gridIndex(x, grid->columns);
+}
+
+/*
+Puts a vehicle at the front of a cell's list
+Parameters: Pointer to the store (*store), vehicle's index (i) and cell (cell)
+*/
+static void linkToCell(VehicleStore *store, int i, int32_t cell) {
+    int32_t first = store->grid.head[cell];
+    store->cell[i] = cell;
+    store->cellPrev[i] = -1;
+    store->cellNext[i] = first;
+    if (first >= 0) store->cellPrev[first] = i;
+    store->grid.head[cell] = i;
+}
+
+/*
+Takes a vehicle out of its cell's list
+Parameters: Pointer to the store (*store) and vehicle's index (i)
+*/
+static void unlinkFromCell(VehicleStore *store, int i) {
+    int32_t prev = store->cellPrev[i];
+    int32_t next = store->cellNext[i];
+    if (prev >= 0) store->cellNext[prev] = next;
+    else store->grid.head[store->cell[i]] = next;
+    if (next >= 0) store->cellPrev[next] = prev;
+}
+
+/*
+Starts a walk over the vehicles centered inside an area. Only the cells the area overlaps are visited,
+so the cost depends on the traffic around the area and not on the total number of vehicles
+Parameters: Pointer to the store (*store) and area (area). To find footprints that touch an area, grow it by VEHICLE_MAX_HALF_LENGTH
+Returns: The walk's state (VehicleQuery), to pass to NextVehicle
+*/
+VehicleQuery BeginVehicleQuery(const VehicleStore *store, Rectangle area) {
+    const VehicleGrid *grid = &store->grid;
+    VehicleQuery query = { 0 };
+    query.area = area;
+    query.firstColumn = gridIndex(area.x, grid->columns);
+    query.lastColumn = gridIndex(area.x + area.width, grid->columns);
+    query.row = gridIndex(area.y, grid->rows);
+    query.lastRow = gridIndex(area.y + area.height, grid->rows);
+    query.column = query.firstColumn;
+    query.next = grid->head[query.row * grid->columns + query.column];
+    return query;
+}
+
+/*
+Moves a walk on to the next vehicle centered inside its area
+Parameters: Pointer to the store (*store) and pointer to the walk's state (*query)
+Returns: Vehicle's index (-1 when there are no more)
+*/
+int NextVehicle(const VehicleStore *store, VehicleQuery *query) {
+    const VehicleGrid *grid = &store->grid;
+    const Rectangle *area = &query->area;
+
+    for (;;) {
+        while (query->next >= 0) {
+            int i = query->next;
+            query->next = store->cellNext[i];
+            if (store->x[i] >= area->x && store->x[i] <= area->x + area->width &&
+                store->y[i] >= area->y && store->y[i] <= area->y + area->height) return i;
+        }
+
+        // Current cell is done, on to the next one (row by row)
+        if (query->column < query->lastColumn) {
+            query->column++;
+        } else if (query->row < query->lastRow) {
+            query->row++;
+            query->column = query->firstColumn;
+        } else {
+            return -1;
+        }
+        query->next = grid->head[query->row * grid->columns + query->column];
+    }
+}
+
+/*
+Adds a vehicle to the store, growing it if it is full
+Parameters: Pointer to the store (*store), type of vehicle (type), position (pos), rotation in degrees, multiple of 90 (rotation),
+speed (speed) and color (color)
+Returns: Vehicle's handle (generation 0 if out of memory)
+*/
+VehicleHandle AddVehicle(VehicleStore *store, TYPE_OF_VEHICLE type, Vector2 pos, int rotation, float speed, Color color) {
+    if (store->count == store->capacity && !reserveVehicles(store, (store->capacity > 0) ? store->capacity * 2 : 16)) return (VehicleHandle){0};
+
+    static const float headings[4][2] = { { 0, 1 }, { -1, 0 }, { 0, -1 }, { 1, 0 } }; // 0, 90, 180, 270 degrees
+    int r = ((rotation / 90) % 4 + 4) % 4;
+    int i = store->count++;
+
+    // Reuse the most recently freed slot, or open a new one (there is always room, slots never outnumber the capacity)
+    uint32_t slot;
+    if (store->freeSlot >= 0) {
+        slot = (uint32_t)store->freeSlot;
+        store->freeSlot = (store->slots[slot].index == UINT32_MAX) ? -1 : (int)store->slots[slot].index;
+    } else {
+        slot = (uint32_t)store->slotCount++;
+        store->slots[slot].generation = 1;
+    }
+    store->slots[slot].index = (uint32_t)i;
+    store->slotOf[i] = slot;
+
+    store->x[i] = pos.x;
+    store->y[i] = pos.y;
+    store->nextX[i] = pos.x; // Not moving until the next update
+    store->nextY[i] = pos.y;
+    store->dirX[i] = headings[r][0];
+    store->dirY[i] = headings[r][1];
+    store->speed[i] = speed;
+    store->type[i] = (uint8_t)type;
+    store->pose[i] = (uint8_t)getVehiclePose(type, r * 90);
+    store->color[i] = color;
+    store->blockedTicks[i] = 0;
+    store->random[i] = (uint32_t)GetRandomValue(1, INT32_MAX); // Never 0, see nextRandom
+    store->edge[i] = NO_ROAD_EDGE; // Joins the road network on its first move
+    store->nextEdge[i] = NO_ROAD_EDGE;
+    store->waypoint[i] = 0;
+    store->destination[i] = 0;
+    store->tripLeft[i] = 0;
+    linkToCell(store, i, gridCell(&store->grid, pos.x, pos.y));
+    return (VehicleHandle){ slot, store->slots[slot].generation };
+}
+
+/*
+Finds where a vehicle currently is in the store's arrays
+Parameters: Pointer to the store (*store) and vehicle's handle (handle)
+Returns: Vehicle's dense index (-1 if the handle is stale)
+*/
+int GetVehicleIndex(const VehicleStore *store, VehicleHandle handle) {
+    if (handle.slot >= (uint32_t)store->slotCount) return -1;
+    const VehicleSlot *slot = &store->slots[handle.slot];
+    if (slot->generation != handle.generation || handle.generation == 0) return -1;
+    return (int)slot->index;
+}
+
+/*
+Finds the handle of a vehicle, to keep a reference to it across removals
+Parameters: Pointer to the store (*store) and vehicle's dense index (i)
+Returns: Vehicle's handle (VehicleHandle)
+*/
+VehicleHandle GetVehicleHandle(const VehicleStore *store, int i) {
+    uint32_t slot = store->slotOf[i];
+    return (VehicleHandle){ slot, store->slots[slot].generation };
+}
+
+/*
+Removes a vehicle: the last vehicle moves into its place, so that the live ones stay contiguous
+Parameters: Pointer to the store (*store) and vehicle's handle (handle)
+Returns: true if removed. Otherwise (stale handle), false
+*/
+bool RemoveVehicle(VehicleStore *store, VehicleHandle handle) {
+    int i = GetVehicleIndex(store, handle);
+    if (i < 0) return false;
+
+    int last = --store->count;
+    unlinkFromCell(store, i);
+    if (i != last) {
+        int32_t cell = store->cell[last];
+        unlinkFromCell(store, last);
+        store->x[i] = store->x[last];
+        store->y[i] = store->y[last];
+        store->nextX[i] = store->nextX[last];
+        store->nextY[i] = store->nextY[last];
+        store->dirX[i] = store->dirX[last];
+        store->dirY[i] = store->dirY[last];
+        store->speed[i] = store->speed[last];
+        store->type[i] = store->type[last];
+        store->pose[i] = store->pose[last];
+        store->color[i] = store->color[last];
+        store->blockedTicks[i] = store->blockedTicks[last];
+        store->random[i] = store->random[last];
+        store->edge[i] = store->edge[last];
+        store->nextEdge[i] = store->nextEdge[last];
+        store->waypoint[i] = store->waypoint[last];
+        store->destination[i] = store->destination[last];
+        store->tripLeft[i] = store->tripLeft[last];
+        store->slotOf[i] = store->slotOf[last];
+        store->slots[store->slotOf[i]].index = (uint32_t)i;
+        linkToCell(store, i, cell);
+    }
+
+    // Invalidate every copy of the handle and push the slot on the free list
+    VehicleSlot *slot = &store->slots[handle.slot];
+    slot->generation = (slot->generation == UINT32_MAX) ? 1 : slot->generation + 1;
+    slot->index = (store->freeSlot < 0) ? UINT32_MAX : (uint32_t)store->freeSlot;
+    store->freeSlot = (int)handle.slot;
+    return true;
+}
+
+/*
+Finds a vehicle's rotation for drawing, from its heading
+Parameters: Pointer to the store (*store) and vehicle's index (i)
+Returns: Rotation in degrees (float)
+*/
+float GetVehicleRotation(const VehicleStore *store, int i) {
+    return atan2f(-store->dirX[i], store->dirY[i]) * RAD2DEG;
+}
+
+/*
+Finds where to draw a vehicle between the last two updates
+Parameters: Pointer to the store (*store), vehicle's index (i) and fraction of a tick since the last update (alpha)
+Returns: Vehicle's center (Vector2)
+*/
+Vector2 GetVehicleRenderPosition(const VehicleStore *store, int i, float alpha) {
+    return (Vector2){ store->nextX[i] + (store->x[i] - store->nextX[i]) * alpha,
+                      store->nextY[i] + (store->y[i] - store->nextY[i]) * alpha };
+}
+
+/*
+Movement step: proposes every vehicle's next position. Vehicles near the player stay where they are
+Parameters: Pointer to the store (*store), range of vehicles (from, to) and player's position (playerPos)
+*/
+static void proposeMovesScalar(VehicleStore *store, int from, int to, Vector2 playerPos) {
+    for (int i = from; i < to; i++) {
+        float dx = store->x[i] - playerPos.x;
+        float dy = store->y[i] - playerPos.y;
+        float step = (dx*dx + dy*dy < STOPPING_DISTANCE * STOPPING_DISTANCE) ? 0.0f : store->speed[i];
+        store->nextX[i] = store->x[i] + store->dirX[i] * step;
+        store->nextY[i] = store->y[i] + store->dirY[i] * step;
+    }
+}
+
+#if defined(__SSE2__)
+/*
+Same as proposeMovesScalar, 4 vehicles at a time
+Parameters: Pointer to the store (*store), range of vehicles (from, to) and player's position (playerPos)
+Returns: End of the vehicles processed (the rest, fewer than 4, are left to proposeMovesScalar)
+*/
+static int proposeMovesSSE2(VehicleStore *store, int from, int to, Vector2 playerPos) {
+    const __m128 px = _mm_set1_ps(playerPos.x);
+    const __m128 py = _mm_set1_ps(playerPos.y);
+    const __m128 stop = _mm_set1_ps(STOPPING_DISTANCE * STOPPING_DISTANCE);
+    int i = from;
+
+    for (; i + 4 <= to; i += 4) {
+        __m128 x = _mm_loadu_ps(store->x + i);
+        __m128 y = _mm_loadu_ps(store->y + i);
+        __m128 dx = _mm_sub_ps(x, px);
+        __m128 dy = _mm_sub_ps(y, py);
+        __m128 distance = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        __m128 step = _mm_and_ps(_mm_cmpge_ps(distance, stop), _mm_loadu_ps(store->speed + i)); // 0 when close to the player
+
+        _mm_storeu_ps(store->nextX + i, _mm_add_ps(x, _mm_mul_ps(_mm_loadu_ps(store->dirX + i), step)));
+        _mm_storeu_ps(store->nextY + i, _mm_add_ps(y, _mm_mul_ps(_mm_loadu_ps(store->dirY + i), step)));
+    }
+    return i;
+}
+#endif
+
+/*
+Finds the free road in front of a vehicle: the gap to the nearest vehicle ahead that overlaps its lane
+Parameters: Pointer to the store (*store), vehicle's index (i), heading to look at (dx, dy), how far past its front bumper to look (range),
+gap that is small enough to stop looking (enough) and pointer to the vehicle in front (*leader), -1 if there is none
+Returns: Gap in pixels, negative if already overlapping (range if the road is clear). Only the first gap up to enough is found,
+which in a jam is usually the first vehicle checked
+*/
+static float gapAhead(const VehicleStore *store, int i, float dx, float dy, float range, float enough, int *leader) {
+    int truck = (store->type[i] == TRUCK);
+    float halfLength = HALF_LENGTH[truck];
+    float halfWidth = HALF_WIDTH[truck];
+
+    // The lane from the center to range past the front, grown so that footprints centered outside it are found too
+    float reach = halfLength + range + VEHICLE_MAX_HALF_LENGTH;
+    float side = halfWidth + VEHICLE_MAX_HALF_LENGTH;
+    Rectangle lane = (dx != 0) ? (Rectangle){ (dx > 0) ? store->x[i] : store->x[i] - reach, store->y[i] - side, reach, 2 * side }
+                               : (Rectangle){ store->x[i] - side, (dy > 0) ? store->y[i] : store->y[i] - reach, 2 * side, reach };
+
+    float gap = range;
+    *leader = -1;
+    VehicleQuery query = BeginVehicleQuery(store, lane);
+    for (int j = NextVehicle(store, &query); j >= 0; j = NextVehicle(store, &query)) {
+        float offsetX = store->x[j] - store->x[i];
+        float offsetY = store->y[j] - store->y[i];
+        float along = offsetX * dx + offsetY * dy;
+        if (j == i || along <= 0) continue; // Itself, level or behind
+
+        // Footprint of the other vehicle along and across our heading
+        int otherTruck = (store->type[j] == TRUCK);
+        bool parallel = fabsf(store->dirX[j] * dx + store->dirY[j] * dy) > 0.5f;
+        float otherAlong = parallel ? HALF_LENGTH[otherTruck] : HALF_WIDTH[otherTruck];
+        float otherAcross = parallel ? HALF_WIDTH[otherTruck] : HALF_LENGTH[otherTruck];
+        if (fabsf(offsetX * dy - offsetY * dx) >= halfWidth + otherAcross) continue; // Not in our lane
+
+        float distance = along - otherAlong - halfLength;
+        if (distance < gap) {
+            gap = distance;
+            *leader = j;
+            if (gap <= enough) break;
+        }
+    }
+    return gap;
+}
+
+/*
+Draws a vehicle's next random number (xorshift). Every vehicle has its own sequence, so the result of a step
+doesn't depend on which thread ran which vehicle
+Parameter: Pointer to the vehicle's state (*state), never 0
+Returns: Random number (uint32_t)
+*/
+static inline uint32_t nextRandom(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/*
+Turns a vehicle (from the next step on): right, left or back, whichever is clear of walls and vehicles first. Failing that,
+whichever is clear of walls (random if none is), unless the new heading must be free of vehicles. Only headings it can turn to in place,
+without clipping into a wall, are considered
+Parameters: Pointer to the store (*store), vehicle's index (i), pointer to map's data (*map) and whether to turn only onto an empty road (mustBeFree)
+Returns: true if it turned. Otherwise, false
+*/
+static bool resteerVehicle(VehicleStore *store, int i, const MapData *map, bool mustBeFree) {
+    float dx = store->dirX[i];
+    float dy = store->dirY[i];
+    TYPE_OF_VEHICLE type = (TYPE_OF_VEHICLE)store->type[i];
+
+    // Relative turns: [Right (+90), Left (+270), Back (+180)]
+    // We favor turning 90 degrees over going fully backwards
+    const float candidates[3][2] = { { -dy, dx }, { dy, -dx }, { -dx, -dy } };
+    int chosen = -1;
+    int wallFree = -1;
+    int fitting[3];
+    int fitCount = 0;
+
+    for (int d = 0; d < 3; d++) {
+        PoseMask pose = headingPose(type, candidates[d][0], candidates[d][1]);
+        if (!IsPoseValid(map, pose, store->x[i], store->y[i])) continue;
+        fitting[fitCount++] = d;
+
+        float testX = store->x[i] + candidates[d][0] * RESTEER_LOOK_AHEAD;
+        float testY = store->y[i] + candidates[d][1] * RESTEER_LOOK_AHEAD;
+        if (!IsPoseValid(map, pose, testX, testY)) continue;
+        if (wallFree < 0) wallFree = d;
+
+        int leader;
+        if (gapAhead(store, i, candidates[d][0], candidates[d][1], RESTEER_LOOK_AHEAD, RESTEER_LOOK_AHEAD, &leader) >= RESTEER_LOOK_AHEAD) {
+            chosen = d;
+            break;
+        }
+    }
+
+    if (chosen < 0) {
+        if (mustBeFree) return false;
+        // If completely stuck (boxed in), pick a random one as a last resort
+        if (fitCount == 0) return false;
+        chosen = (wallFree >= 0) ? wallFree : fitting[nextRandom(&store->random[i]) % fitCount];
+    }
+
+    store->nextDirX[i] = candidates[chosen][0];
+    store->nextDirY[i] = candidates[chosen][1];
+    store->pose[i] = (uint8_t)headingPose(type, candidates[chosen][0], candidates[chosen][1]);
+    return true;
+}
+
+// Where a vehicle on the road network drives in one step (see steerVehicle)
+typedef struct {
+    Vector2 heading; // Axis it drives along
+    Vector2 end;     // Where the leg ends. The vehicle drives straight at it, so on a slanted lane it drifts sideways as it goes
+    float reach;     // Distance along the heading to the end
+} RouteLeg;
+
+/*
+Finds the axis a leg of an edge's lane runs along: that of its piece of centerline
+Parameters: Pointer to the road graph (*graph), edge (edge) and leg (k)
+Returns: Unit vector along an axis (Vector2)
+*/
+static Vector2 legHeading(const RoadGraph *graph, uint32_t edge, uint32_t k) {
+    return GetRoadPieceHeading(GetRoadEdgePoint(graph, edge, k - 1), GetRoadEdgePoint(graph, edge, k));
+}
+
+/*
+Finds where a leg of an edge's lane ends: at the next bend, or for the last leg, where the vehicle turns onto the next edge
+Parameters: Pointer to map's data (*map), lane footprint (footprint), edge (edge), leg (k) and the next edge (nextEdge)
+Returns: The point (Vector2)
+*/
+static Vector2 legEnd(const MapData *map, int footprint, uint32_t edge, uint32_t k, uint32_t nextEdge) {
+    const RoadGraph *graph = &map->roads;
+    const RoadLanes *lanes = &map->lanes;
+    uint32_t last = graph->segments[graph->edgeSegment[edge]].pointCount - 1;
+    if (k < last || nextEdge == NO_ROAD_EDGE) return lanes->points[footprint][lanes->pointStart[edge] + k];
+    return lanes->turnPoints[footprint][lanes->turnStart[edge] + nextEdge - graph->edgeStart[graph->edgeTarget[edge]]];
+}
+
+/*
+Finds the point of a leg level with a position, at the same distance along the leg's axis, where a vehicle moving sideways enters it
+Parameters: Pointer to map's data (*map), lane footprint (footprint), edge (edge), leg (k), the next edge (nextEdge),
+the position (position) and pointer to the point (*beside)
+Returns: true if the point lies on the leg. Otherwise (the position is level with some other part of the lane), false
+*/
+static bool legPointBeside(const MapData *map, int footprint, uint32_t edge, uint32_t k, uint32_t nextEdge, Vector2 position, Vector2 *beside) {
+    Vector2 start = map->lanes.points[footprint][map->lanes.pointStart[edge] + k - 1];
+    Vector2 end = legEnd(map, footprint, edge, k, nextEdge);
+    Vector2 heading = legHeading(&map->roads, edge, k);
+    float length = (end.x - start.x) * heading.x + (end.y - start.y) * heading.y;
+    float t = (length > ROUTE_REACHED) ? ((position.x - start.x) * heading.x + (position.y - start.y) * heading.y) / length : 0.0f;
+    *beside = (Vector2){ start.x + (end.x - start.x) * t, start.y + (end.y - start.y) * t };
+    return t >= 0 && t <= 1;
+}
+
+/*
+Draws a vehicle's next destination, a restaurant or a house, and how many intersections it drives towards it
+Parameters: Pointer to the store (*store), vehicle's index (i) and pointer to map's data (*map)
+*/
+static void drawDestination(VehicleStore *store, int i, const MapData *map) {
+    if (map->destinations.count == 0) return;
+    store->destination[i] = nextRandom(&store->random[i]) % (uint32_t)map->destinations.count;
+    store->tripLeft[i] = (uint8_t)(TRIP_MIN_INTERSECTIONS + nextRandom(&store->random[i]) % (TRIP_MAX_INTERSECTIONS - TRIP_MIN_INTERSECTIONS + 1));
+}
+
+/*
+Picks the edge a vehicle turns onto at the end of another: the first one of the shortest way to its destination,
+whose distance from every node was measured at load (see InitTrafficDestinations), so the choice costs one lookup per road leaving the node.
+Only turns its lane can drive are considered, and it never goes back the way it came unless the road ends there
+Parameters: Pointer to the store (*store), vehicle's index (i), pointer to map's data (*map) and edge it is about to drive (edge)
+Returns: The next edge (uint32_t), NO_ROAD_EDGE if there is no open turn
+*/
+static uint32_t pickNextEdge(VehicleStore *store, int i, const MapData *map, uint32_t edge) {
+    const RoadGraph *graph = &map->roads;
+    uint32_t node = graph->edgeTarget[edge];
+    uint32_t first = graph->edgeStart[node];
+    uint32_t last = graph->edgeStart[node + 1];
+    int footprint = (store->type[i] == TRUCK);
+    const uint8_t *turns = map->lanes.turns[footprint] + map->lanes.turnStart[edge];
+    const RoadTargets *destinations = &map->destinations;
+
+    uint32_t best = NO_ROAD_EDGE;
+    uint32_t back = NO_ROAD_EDGE;
+    float bestCost = INFINITY;
+    for (uint32_t e = first; e < last; e++) {
+        if (!(turns[e - first] & LANE_TURN_OPEN)) continue;
+        if (graph->edgeSegment[e] == graph->edgeSegment[edge]) {
+            back = e;
+            continue;
+        }
+
+        // Without a destination it can reach, any road will do
+        float distance = (destinations->count > 0) ? destinations->nodeDistance[(size_t)store->destination[i] * graph->nodeCount + graph->edgeTarget[e]] : INFINITY;
+        float cost = isinf(distance) ? (float)(nextRandom(&store->random[i]) & 0xFFFF) : graph->segments[graph->edgeSegment[e]].length + distance;
+        if (cost < bestCost) {
+            bestCost = cost;
+            best = e;
+        }
+    }
+    return (best != NO_ROAD_EDGE) ? best : back; // Dead end
+}
+
+/*
+Puts a vehicle into a lane, from wherever it is: straight to the end of the leg it is next to, or of the one after, along the leg's
+axis and at most as much sideways as forward. Failing that, sideways onto the leg first. Unlike the lanes themselves, this move
+wasn't checked at load, so it costs a walk over the pixels it crosses
+Parameters: Pointer to the store (*store), vehicle's index (i), pointer to map's data (*map), edge (edge), leg the vehicle is next to (k)
+and the next edge (nextEdge)
+Returns: true if it found a way in (its route is set, the next step drives it). Otherwise, false
+*/
+static bool enterLane(VehicleStore *store, int i, const MapData *map, uint32_t edge, uint32_t k, uint32_t nextEdge) {
+    const RoadGraph *graph = &map->roads;
+    TYPE_OF_VEHICLE type = (TYPE_OF_VEHICLE)store->type[i];
+    int footprint = (type == TRUCK);
+    Vector2 position = { store->x[i], store->y[i] };
+    uint32_t waypoint = k | ROUTE_SIDEWAYS;
+
+    for (uint32_t leg = k; leg <= k + 1 && leg < graph->segments[graph->edgeSegment[edge]].pointCount; leg++) {
+        Vector2 end = legEnd(map, footprint, edge, leg, nextEdge);
+        Vector2 heading = legHeading(graph, edge, leg);
+        float along = (end.x - position.x) * heading.x + (end.y - position.y) * heading.y;
+        float across = (end.x - position.x) * heading.y - (end.y - position.y) * heading.x;
+        if (along > ROUTE_REACHED && fabsf(across) <= along && IsLaneClear(map, headingPose(type, heading.x, heading.y), position, end)) {
+            waypoint = leg;
+            break;
+        }
+    }
+    if (waypoint & ROUTE_SIDEWAYS) {
+        Vector2 beside;
+        if (!legPointBeside(map, footprint, edge, k, nextEdge, position, &beside)) return false;
+        Vector2 side = GetRoadPieceHeading(position, beside);
+        if (!IsLaneClear(map, headingPose(type, side.x, side.y), position, beside)) return false;
+    }
+
+    store->edge[i] = edge;
+    store->waypoint[i] = waypoint;
+    store->nextEdge[i] = nextEdge;
+    return true;
+}
+
+/*
+Puts a vehicle on the road network, on the nearest centerline: into the lane that runs closest to its heading or else the other one
+(see enterLane). Runs once per vehicle, or on every move while it drives around a part of the map
+the network leaves out (then the search stops at ROUTE_JOIN_DISTANCE)
+Parameters: Pointer to the store (*store), vehicle's index (i) and pointer to map's data (*map)
+Returns: true if it joined. Otherwise (no road close enough, or no way into a lane from here), false
+*/
+static bool joinRoad(VehicleStore *store, int i, const MapData *map) {
+    const RoadRouter *router = &map->router;
+    const RoadGraph *graph = &router->graph;
+    RoadPosition road;
+    if (!FindNearestRoadWithin(router, (Vector2){ store->x[i], store->y[i] }, ROUTE_JOIN_DISTANCE, &road)) return false;
+
+    // The piece of the centerline the nearest point lies on
+    const RoadSegment *segment = &graph->segments[road.segment];
+    const Vector2 *points = graph->points + segment->firstPoint;
+    uint32_t piece = 0;
+    float offset = road.offset;
+    for (; piece + 2 < segment->pointCount; piece++) {
+        float length = hypotf(points[piece + 1].x - points[piece].x, points[piece + 1].y - points[piece].y);
+        if (offset <= length) break;
+        offset -= length;
+    }
+    bool forward = (points[piece + 1].x - points[piece].x) * store->dirX[i] + (points[piece + 1].y - points[piece].y) * store->dirY[i] >= 0;
+    if (store->tripLeft[i] == 0) drawDestination(store, i, map);
+
+    int footprint = (store->type[i] == TRUCK);
+    for (int side = 0; side < 2; side++, forward = !forward) {
+        uint32_t node = segment->nodes[forward ? 0 : 1];
+        uint32_t edge = NO_ROAD_EDGE;
+        for (uint32_t e = graph->edgeStart[node]; e < graph->edgeStart[node + 1]; e++) {
+            if (graph->edgeSegment[e] == road.segment && IsForwardRoadEdge(graph, e) == forward) edge = e;
+        }
+        if (edge == NO_ROAD_EDGE || !map->lanes.open[footprint][edge]) continue;
+
+        uint32_t k = forward ? piece + 1 : segment->pointCount - 1 - piece;
+        if (enterLane(store, i, map, edge, k, pickNextEdge(store, i, map, edge))) return true;
+    }
+    return false;
+}
+
+/*
+Moves a vehicle's route on to the next leg of its lane, and onto the next edge at the end of the current one. There it counts
+the intersection, and draws a new destination once it arrives or its trip runs out
+Parameters: Pointer to the store (*store), vehicle's index (i) and pointer to map's data (*map)
+*/
+static void advanceRoute(VehicleStore *store, int i, const MapData *map) {
+    const RoadGraph *graph = &map->roads;
+    uint32_t edge = store->edge[i];
+    store->waypoint[i] &= ~ROUTE_SIDEWAYS;
+    if (++store->waypoint[i] < graph->segments[graph->edgeSegment[edge]].pointCount) return;
+
+    uint32_t next = store->nextEdge[i];
+    store->edge[i] = next;
+    if (next == NO_ROAD_EDGE) return; // Nowhere to go, it leaves the network and joins it again
+    uint8_t turn = map->lanes.turns[store->type[i] == TRUCK][map->lanes.turnStart[edge] + next - graph->edgeStart[graph->edgeTarget[edge]]];
+    store->waypoint[i] = (turn & LANE_TURN_JOG) ? 1 | ROUTE_SIDEWAYS : 1; // A jog: the next lane starts beside where this one ends
+
+    uint32_t node = graph->edgeTarget[next];
+    if (graph->edgeStart[node + 1] - graph->edgeStart[node] > 2 && store->tripLeft[i] > 0) store->tripLeft[i]--;
+    // Arrived once it drives the destination's road
+    if (store->tripLeft[i] == 0 || (map->destinations.count > 0 && graph->edgeSegment[next] == map->destinations.roads[store->destination[i]].segment)) {
+        drawDestination(store, i, map);
+    }
+    store->nextEdge[i] = pickNextEdge(store, i, map, next);
+}
+
+/*
+Finds where a vehicle on the road network drives next: to the end of the current leg of its lane, along the leg's axis. Legs already
+reached are skipped, so the cost per step is constant. The lanes were checked against the pose masks at load (see BuildRoadLanes),
+so the vehicle never touches a wall on the way
+Parameters: Pointer to the store (*store), vehicle's index (i) and pointer to map's data (*map)
+Returns: The next leg of its route (RouteLeg), with a reach of 0 if it has to wait a step
+*/
+static RouteLeg steerVehicle(VehicleStore *store, int i, const MapData *map) {
+    const RoadGraph *graph = &map->roads;
+    int footprint = (store->type[i] == TRUCK);
+    Vector2 position = { store->x[i], store->y[i] };
+    RouteLeg leg = { 0 };
+
+    for (int advance = 0; advance < ROUTE_MAX_ADVANCES && store->edge[i] != NO_ROAD_EDGE; advance++) {
+        uint32_t edge = store->edge[i];
+        uint32_t k = store->waypoint[i] & ~ROUTE_SIDEWAYS;
+        if (store->waypoint[i] & ROUTE_SIDEWAYS) {
+            // Sideways onto the leg first, where it is level with the vehicle
+            legPointBeside(map, footprint, edge, k, store->nextEdge[i], position, &leg.end);
+            leg.heading = GetRoadPieceHeading(position, leg.end);
+            leg.reach = (leg.end.x - position.x) * leg.heading.x + (leg.end.y - position.y) * leg.heading.y;
+            if (leg.reach > ROUTE_REACHED) return leg;
+            store->waypoint[i] = k;
+        }
+        leg.end = legEnd(map, footprint, edge, k, store->nextEdge[i]);
+        leg.heading = legHeading(graph, edge, k);
+        leg.reach = (leg.end.x - position.x) * leg.heading.x + (leg.end.y - position.y) * leg.heading.y;
+        if (leg.reach > ROUTE_REACHED) return leg;
+
+        advanceRoute(store, i, map);
+    }
+    leg.heading = (Vector2){ store->dirX[i], store->dirY[i] };
+    leg.reach = 0; // Only after degenerate legs, or off the network: the next step finds the way again
+    return leg;
+}
+
+/*
+Turns a vehicle on the road network around (from the next step on): it drives back along the same road, into the other lane
+(see enterLane)
+Parameters: Pointer to the store (*store), vehicle's index (i), pointer to map's data (*map) and whether to turn only onto an empty road (mustBeFree)
+Returns: true if it turned. Otherwise, false
+*/
+static bool turnAround(VehicleStore *store, int i, const MapData *map, bool mustBeFree) {
+    const RoadGraph *graph = &map->roads;
+    uint32_t edge = store->edge[i];
+    uint32_t back = GetReverseRoadEdge(graph, edge);
+    if ((store->waypoint[i] & ROUTE_SIDEWAYS) || !map->lanes.open[store->type[i] == TRUCK][back]) return false; // Moving into its lane, or no lane back
+
+    // The leg of the other lane that runs alongside
+    uint32_t k = graph->segments[graph->edgeSegment[edge]].pointCount - store->waypoint[i];
+    Vector2 heading = legHeading(graph, back, k);
+    int leader;
+    if (mustBeFree && gapAhead(store, i, heading.x, heading.y, RESTEER_LOOK_AHEAD, RESTEER_LOOK_AHEAD, &leader) < RESTEER_LOOK_AHEAD) return false;
+
+    return enterLane(store, i, map, back, k, pickNextEdge(store, i, map, back));
+}
+
+/*
+Finds a vehicle's footprint (axis aligned) at some position
+Parameters: Pointer to the store (*store), vehicle's index (i) and position's coordinates (x, y)
+Returns: The footprint (Rectangle)
+*/
+static Rectangle footprintAt(const VehicleStore *store, int i, float x, float y) {
+    int truck = (store->type[i] == TRUCK);
+    float halfX = (store->dirX[i] != 0) ? HALF_LENGTH[truck] : HALF_WIDTH[truck];
+    float halfY = (store->dirX[i] != 0) ? HALF_WIDTH[truck] : HALF_LENGTH[truck];
+    return (Rectangle){ x - halfX, y - halfY, 2 * halfX, 2 * halfY };
+}
+
+/*
+Moves a vehicle (from the next step on) out of the way of an oncoming one, sideways and away from it, if the road there is clear
+Parameters: Pointer to the store (*store), vehicle's index (i), oncoming vehicle's index (other), largest sidestep (step) and pointer to map's data (*map)
+Returns: true if it moved. Otherwise, false
+*/
+static bool sidestepVehicle(VehicleStore *store, int i, int other, float step, const MapData *map) {
+    float rightX = -store->dirY[i]; // Right (+90) of the heading
+    float rightY = store->dirX[i];
+    float side = (store->x[other] - store->x[i]) * rightX + (store->y[other] - store->y[i]) * rightY;
+    float away = (side > 0) ? -step : step;
+
+    float x = store->x[i] + rightX * away;
+    float y = store->y[i] + rightY * away;
+    if (!IsPoseValid(map, (PoseMask)store->pose[i], x, y)) return false;
+
+    Rectangle footprint = footprintAt(store, i, x, y);
+    Rectangle around = { footprint.x - VEHICLE_MAX_HALF_LENGTH, footprint.y - VEHICLE_MAX_HALF_LENGTH,
+                         footprint.width + 2 * VEHICLE_MAX_HALF_LENGTH, footprint.height + 2 * VEHICLE_MAX_HALF_LENGTH };
+    VehicleQuery query = BeginVehicleQuery(store, around);
+    for (int j = NextVehicle(store, &query); j >= 0; j = NextVehicle(store, &query)) {
+        if (j != i && j != other && CheckCollisionRecs(footprint, footprintAt(store, j, store->x[j], store->y[j]))) return false;
+    }
+
+    store->nextX[i] = x;
+    store->nextY[i] = y;
+    return true;
+}
+
+/*
+Reorders one of the store's arrays
+Parameters: The array (*array), size of its elements (size), new order of the elements (*order), number of elements (count)
+and a buffer of count * size bytes (*scratch)
+*/
+static void permuteArray(void *array, size_t size, const uint32_t *order, int count, void *scratch) {
+    const char *from = array;
+    char *to = scratch;
+    for (int k = 0; k < count; k++) memcpy(to + k * size, from + order[k] * size, size);
+    memcpy(array, scratch, (size_t)count * size);
+}
+
+/*
+Sorts the vehicles by grid cell (counting sort), so that the vehicles of a cell sit next to each other in memory
+and the neighbor lookups of the movement step stay in cache. Handles are unaffected
+Parameter: Pointer to the store (*store)
+*/
+static void sortVehiclesByCell(VehicleStore *store) {
+    int cells = store->grid.columns * store->grid.rows;
+    int count = store->count;
+    uint32_t *start = calloc((size_t)cells + 1, sizeof(uint32_t));
+    uint32_t *order = malloc((size_t)count * sizeof(uint32_t));
+    void *scratch = malloc((size_t)count * sizeof(float)); // Largest element below
+    if (start == NULL || order == NULL || scratch == NULL) {
+        free(start); free(order); free(scratch);
+        return;
+    }
+
+    for (int i = 0; i < count; i++) start[store->cell[i] + 1]++;
+    for (int c = 0; c < cells; c++) start[c + 1] += start[c];
+    for (int i = 0; i < count; i++) order[start[store->cell[i]]++] = (uint32_t)i;
+
+    permuteArray(store->x, sizeof(float), order, count, scratch);
+    permuteArray(store->y, sizeof(float), order, count, scratch);
+    permuteArray(store->dirX, sizeof(float), order, count, scratch);
+    permuteArray(store->dirY, sizeof(float), order, count, scratch);
+    permuteArray(store->speed, sizeof(float), order, count, scratch);
+    permuteArray(store->type, sizeof(uint8_t), order, count, scratch);
+    permuteArray(store->pose, sizeof(uint8_t), order, count, scratch);
+    permuteArray(store->color, sizeof(Color), order, count, scratch);
+    permuteArray(store->blockedTicks, sizeof(uint16_t), order, count, scratch);
+    permuteArray(store->random, sizeof(uint32_t), order, count, scratch);
+    permuteArray(store->edge, sizeof(uint32_t), order, count, scratch);
+    permuteArray(store->nextEdge, sizeof(uint32_t), order, count, scratch);
+    permuteArray(store->waypoint, sizeof(uint32_t), order, count, scratch);
+    permuteArray(store->destination, sizeof(uint32_t), order, count, scratch);
+    permuteArray(store->tripLeft, sizeof(uint8_t), order, count, scratch);
+    permuteArray(store->slotOf, sizeof(uint32_t), order, count, scratch);
+    permuteArray(store->cell, sizeof(int32_t), order, count, scratch);
+
+    // Relink every cell in index order
+    for (int c = 0; c < cells; c++) store->grid.head[c] = -1;
+    for (int i = count - 1; i >= 0; i--) {
+        store->slots[store->slotOf[i]].index = (uint32_t)i;
+        linkToCell(store, i, store->cell[i]);
+    }
+
+    free(start);
+    free(order);
+    free(scratch);
+}
+
+/*
+Decides the next position and heading of a vehicle: it follows its route on the road network (or, on a map without one,
+drives straight and turns if it hits a wall) and the vehicle in front of it. Vehicles stuck behind each other give way by priority (see below).
+Reads the current state of every vehicle but writes only this vehicle's next state and route, so vehicles can be decided in any order, in parallel
+Parameters: Pointer to the store (*store), vehicle's index (i) and pointer to map's data (*map)
+*/
+static void decideVehicle(VehicleStore *store, int i, const MapData *map) {
+    store->nextDirX[i] = store->dirX[i];
+    store->nextDirY[i] = store->dirY[i];
+
+    float step = (store->nextX[i] - store->x[i]) * store->dirX[i] + (store->nextY[i] - store->y[i]) * store->dirY[i];
+    if (step <= 0) return; // Waiting for the player
+
+    // Route: the heading comes from the lane, and the step stops at the end of its leg. A vehicle that failed to join and hasn't moved since
+    // would fail again, so it only tries once it moves
+    bool onRoad = store->edge[i] != NO_ROAD_EDGE || (store->blockedTicks[i] == 0 && joinRoad(store, i, map));
+    RouteLeg leg = { 0 };
+    if (onRoad) {
+        leg = steerVehicle(store, i, map);
+        onRoad = store->edge[i] != NO_ROAD_EDGE; // Unless it left the network at a dead end it can't turn at
+    }
+    if (onRoad) {
+        if (leg.heading.x != store->dirX[i] || leg.heading.y != store->dirY[i]) {
+            store->nextDirX[i] = leg.heading.x;
+            store->nextDirY[i] = leg.heading.y;
+            store->pose[i] = (uint8_t)headingPose((TYPE_OF_VEHICLE)store->type[i], leg.heading.x, leg.heading.y);
+        }
+        if (leg.reach < step) step = leg.reach;
+    }
+    float dirX = store->nextDirX[i];
+    float dirY = store->nextDirY[i];
+
+    // Car following, through the grid: close up to FOLLOW_GAP behind the vehicle in front, no further
+    int leader;
+    float gap = gapAhead(store, i, dirX, dirY, step + FOLLOW_GAP, FOLLOW_GAP, &leader) - FOLLOW_GAP;
+    if (gap < step) step = (gap > 0) ? gap : 0;
+
+    // On the road network straight at the end of the leg, which keeps the vehicle on its lane
+    if (onRoad) {
+        float t = (leg.reach > 0) ? step / leg.reach : 0.0f;
+        store->nextX[i] = store->x[i] + (leg.end.x - store->x[i]) * t;
+        store->nextY[i] = store->y[i] + (leg.end.y - store->y[i]) * t;
+    } else {
+        store->nextX[i] = store->x[i] + dirX * step;
+        store->nextY[i] = store->y[i] + dirY * step;
+    }
+
+    if (step == 0) {
+        // Gridlock: two vehicles nose to nose squeeze past each other, both stepping aside. If the road is too narrow,
+        // the one with the higher slot (a fixed priority) turns onto an empty road, as soon as there is one.
+        // Any other jam (e.g. a cycle at a junction) clears when its vehicles run out of patience: first they only turn
+        // onto an empty road, later onto any road. On the road network, where roads wide enough have a lane per direction,
+        // vehicles nose to nose are on a single lane road and turning means heading back the way they came
+        bool headOn = leader >= 0 && store->dirX[leader] * dirX + store->dirY[leader] * dirY < -0.5f;
+        bool mustBeFree = store->blockedTicks[i] < 2 * GRIDLOCK_TICKS;
+        bool turned = false;
+        if (headOn && !onRoad && sidestepVehicle(store, i, leader, store->speed[i], map)) {
+            turned = true;
+        } else if ((headOn && store->slotOf[i] > store->slotOf[leader]) || store->blockedTicks[i] >= GRIDLOCK_TICKS) {
+            turned = onRoad ? turnAround(store, i, map, mustBeFree) : resteerVehicle(store, i, map, mustBeFree);
+        }
+
+        if (turned) store->blockedTicks[i] = 0;
+        else if (store->blockedTicks[i] < UINT16_MAX) store->blockedTicks[i]++;
+        return;
+    }
+    store->blockedTicks[i] = 0;
+
+    if (!onRoad && !IsPoseValid(map, (PoseMask)store->pose[i], store->nextX[i], store->nextY[i])) {
+        // Stay put, so that we don't clip into the wall, and find another way
+        store->nextX[i] = store->x[i];
+        store->nextY[i] = store->y[i];
+        resteerVehicle(store, i, map, false);
+    }
+}
+
+// A band of the (cell sorted) vehicle arrays, decided by one job
+typedef struct {
+    VehicleStore *store;
+    const MapData *map;
+    Vector2 playerPos;
+    int from;
+    int to;
+} TrafficTile;
+
+/*
+Propose phase of a tile: the vectorized step for its vehicles, then every vehicle's decision
+Parameter: Pointer to the tile (TrafficTile *)
+*/
+static void proposeTile(void *data) {
+    TrafficTile *tile = data;
+    int done = tile->from;
+#if defined(__SSE2__)
+    done = proposeMovesSSE2(tile->store, tile->from, tile->to, tile->playerPos);
+#endif
+    proposeMovesScalar(tile->store, done, tile->to, tile->playerPos);
+
+    for (int i = tile->from; i < tile->to; i++) decideVehicle(tile->store, i, tile->map);
+}
+
+/*
+Swaps two arrays of the store
+Parameters: Pointers to the two arrays (**a, **b)
+*/
+static void swapArrays(float **a, float **b) {
+    float *temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+/*
+Controls vehicles' movement in two phases. Propose: every vehicle decides its next position and heading from the current state
+only, in tiles that run as parallel jobs. Commit: the next state becomes the current one and vehicles that changed cell move in the grid.
+The result doesn't depend on the number of threads
+Parameters: Pointer to the vehicle store (*store), pointer to map's data (*map) and player's position (playerPos)
+*/
+void updateTraffic(VehicleStore *store, const MapData *map, Vector2 playerPos) {
+    if (--store->sortCountdown <= 0) {
+        sortVehiclesByCell(store);
+        store->sortCountdown = SORT_INTERVAL;
+    }
+
+    // A few tiles per thread, so that threads that finish early can steal the rest
+    int tileCount = (GetJobWorkerCount() + 1) * 4;
+    if (tileCount > MAX_TRAFFIC_TILES) tileCount = MAX_TRAFFIC_TILES;
+    if (tileCount > store->count / TRAFFIC_TILE_MIN_VEHICLES) tileCount = store->count / TRAFFIC_TILE_MIN_VEHICLES;
+    if (tileCount < 1) tileCount = 1;
+
+    TrafficTile tiles[MAX_TRAFFIC_TILES];
+    Job jobs[MAX_TRAFFIC_TILES];
+    for (int t = 0; t < tileCount; t++) {
+        tiles[t] = (TrafficTile){ store, map, playerPos, (int)((int64_t)store->count * t / tileCount), (int)((int64_t)store->count * (t + 1) / tileCount) };
+    }
+
+    if (tileCount == 1) {
+        proposeTile(&tiles[0]);
+    } else {
+        for (int t = 0; t < tileCount; t++) {
+            InitJob(&jobs[t], "traffic", proposeTile, &tiles[t]);
+            SubmitJob(&jobs[t]);
+        }
+        for (int t = 0; t < tileCount; t++) WaitForJob(&jobs[t]);
+    }
+
+    // Commit
+    swapArrays(&store->x, &store->nextX);
+    swapArrays(&store->y, &store->nextY);
+    swapArrays(&store->dirX, &store->nextDirX);
+    swapArrays(&store->dirY, &store->nextDirY);
+
+    // Most steps stay inside the cell, only crossings touch the grid
+    for (int i = 0; i < store->count; i++) {
+        int32_t cell = gridCell(&store->grid, store->x[i], store->y[i]);
+        if (cell != store->cell[i]) {
+            unlinkFromCell(store, i);
+            linkToCell(store, i, cell);
+        }
+    }
+}
@@ -0,0 +1,107 @@
+/*
+ * Πανεπιστήμιο: Αριστοτέλειο Πανεπιστήμιο Θεσσαλονίκης
+ * Τμήμα: Τμήμα Ηλεκτρολόγων Μηχανικών και Μηχανικών Υπολογιστών
+ * Μάθημα: Δομημένος Προγραμματισμός (004)
+ * Τίτλος Εργασίας: Delivery Rush
+ * Συγγραφείς:
+ * - Αντώνιος Καραφώτης (ΑΕΜ: 11891)
+ * - Νικόλαος Αμοιρίδης (ΑΕΜ: 11836)
+ * Άδεια Χρήσης: MIT License
+ * (Δείτε το αρχείο LICENSE.txt για το πλήρες κείμενο)
+ */
+
+#ifndef VEHICLES_H
+#define VEHICLES_H
+
+#include <stdint.h>
+#include "raylib.h"
+#include "mapData.h"
+
+#define STOPPING_DISTANCE 20.0f
+#define VEHICLE_GRID_CELL_SIZE 24   // Longest footprint (truck, 22 pixels) rounded up
+#define VEHICLE_MAX_HALF_LENGTH 11.0f // No footprint reaches further than this from its center
+#define MAX_TRAFFIC_TILES 64 // Jobs per traffic update
+#define NO_ROAD_EDGE UINT32_MAX // Route of a vehicle that hasn't joined the road network (yet)
+#define ROUTE_SIDEWAYS 0x80000000u // Set in a waypoint while the vehicle moves sideways into the lane, before it drives the leg
+
+typedef enum { CAR, TRUCK, POLICE } TYPE_OF_VEHICLE;
+
+// Stable reference to a vehicle. Dense indices change when vehicles are removed, handles don't.
+// A handle goes stale once its vehicle is removed (generation 0 is never valid)
+typedef struct {
+    uint32_t slot;
+    uint32_t generation;
+} VehicleHandle;
+
+typedef struct {
+    uint32_t index;      // Dense index of the vehicle while in use, next free slot while free
+    uint32_t generation; // Bumped every time the slot is freed
+} VehicleSlot;
+
+// Uniform grid over the map: every cell holds a doubly linked list (through the store's cellNext/cellPrev) of the vehicles centered in it
+typedef struct {
+    int columns;
+    int rows;
+    int32_t *head; // First vehicle of every cell (-1 if empty)
+} VehicleGrid;
+
+// Walks the vehicles centered inside an area, cell by cell (see BeginVehicleQuery)
+typedef struct {
+    Rectangle area;
+    int firstColumn, lastColumn, lastRow;
+    int column, row;
+    int32_t next; // Next candidate of the current cell (-1 to move on to the next cell)
+} VehicleQuery;
+
+// All vehicles as a structure of arrays, so that the movement step runs over contiguous floats.
+// Live vehicles are always the first count entries; the arrays grow on demand.
+// Headings are unit vectors along the axes: (0, 1) is rotation 0, (-1, 0) is 90, (0, -1) is 180 and (1, 0) is 270
+typedef struct {
+    int count;
+    int capacity;
+    float *x;     // Center
+    float *y;
+    float *dirX;  // Heading (unit vector)
+    float *dirY;
+    float *speed; // Pixels per tick of updateTraffic
+    uint8_t *type; // TYPE_OF_VEHICLE
+    uint8_t *pose; // PoseMask of the footprint in the current heading
+    Color *color;
+    float *nextX; // Next state, written by the propose phase of updateTraffic and swapped in by its commit phase.
+                  // Between two updates, the positions before the last one (for render interpolation)
+    float *nextY;
+    float *nextDirX;
+    float *nextDirY;
+    uint16_t *blockedTicks; // Ticks spent stuck behind another vehicle
+    uint32_t *random;       // State of every vehicle's own random numbers
+    uint32_t *edge;         // Road edge (index of the graph's edgeTarget) the vehicle drives along, NO_ROAD_EDGE until it joins the network
+    uint32_t *nextEdge;     // Edge it turns onto at the end of edge, picked as it enters edge
+    uint32_t *waypoint;     // Leg of the edge's lane it drives (the centerline point the leg ends at, counted from the edge's start), plus ROUTE_SIDEWAYS
+    uint32_t *destination;  // Restaurant or house it drives towards (see MapData's destinations)
+    uint8_t *tripLeft;      // Intersections left before it draws another destination
+    uint32_t *slotOf;   // Slot of every dense index
+    VehicleSlot *slots; // Handle table, same capacity as the arrays
+    int slotCount;      // Slots ever used
+    int freeSlot;       // Head of the free slots' list (-1 if empty)
+    VehicleGrid grid;   // Kept up to date by AddVehicle, RemoveVehicle and updateTraffic
+    int32_t *cell;      // Grid cell of every vehicle
+    int32_t *cellNext;  // Neighbors in the cell's list (-1 at the ends)
+    int32_t *cellPrev;
+    int sortCountdown;  // Steps until the arrays are sorted by cell again (see updateTraffic)
+} VehicleStore;
+
+// functions
+VehicleStore LoadVehicleStore(int capacity, int worldWidth, int worldHeight);
+void UnloadVehicleStore(VehicleStore *store);
+PoseMask getVehiclePose(TYPE_OF_VEHICLE type, int rotation);
+VehicleHandle AddVehicle(VehicleStore *store, TYPE_OF_VEHICLE type, Vector2 pos, int rotation, float speed, Color color);
+bool RemoveVehicle(VehicleStore *store, VehicleHandle handle);
+int GetVehicleIndex(const VehicleStore *store, VehicleHandle handle);
+VehicleHandle GetVehicleHandle(const VehicleStore *store, int i);
+float GetVehicleRotation(const VehicleStore *store, int i);
+Vector2 GetVehicleRenderPosition(const VehicleStore *store, int i, float alpha);
+VehicleQuery BeginVehicleQuery(const VehicleStore *store, Rectangle area);
+int NextVehicle(const VehicleStore *store, VehicleQuery *query);
+void updateTraffic(VehicleStore *store, const MapData *map, Vector2 playerPos);
+
+#endif